@@ -5,6 +5,7 @@
  */
 
 #include "autentication.h"
+#include "chima_kernels.h"
 #include "utils.h"
 #include <string.h>
 
@@ -273,25 +274,13 @@ static void BlockCipher(uint32_t *pui32Ciphertext, const uint32_t *pui32Key, con
 /* API do Hash Lesamnta-LW    */
 /*============================*/
 
-/**
- * @brief Estado interno do hash
- * 
- */
-typedef struct {
-    int iHashBitLen;
-    uint32_t ui32MessageLength[2];
-    uint32_t ui32RemainingLength;
-    uint32_t ui32Message[MessageBlockLengthInWord];
-    uint32_t ui32Hash[HashLengthInWord];
-} hashState;
-
 /**
  * @brief Inicializa a estrutura de estado do hash.
  *
  * @param pState Estrutura de estado
  * @return Código de erro
  */
-static HashReturn LesamntaLW_Init(hashState *pState)
+HashReturn LesamntaLW_Init(hashState *pState)
 {
     pState->iHashBitLen = LESAMNTALW_HASH_BITLENGTH;
     pState->ui32MessageLength[0] = 0;
@@ -334,12 +323,12 @@ static void SetRemainingMessage(uint32_t *pui32Message, uint32_t ui32RemainingLe
 }
 
 /**
- * @brief Função de compressão do Lesamnta-LW.
+ * @brief Função de compressão do Lesamnta-LW (C portátil).
  *
  * @param pui32Hash    Vetor do hash em palavras
  * @param pui32Message Bloco de mensagem
  */
-static void CompressionFunction(uint32_t *pui32Hash, const uint32_t *pui32Message)
+static void CompressionFunctionPortable(uint32_t *pui32Hash, const uint32_t *pui32Message)
 {
     uint32_t ui32Key[KeyLengthInWord] = {0};
     uint32_t ui32Plaintext[BlockLengthInWord] = {0};
@@ -351,18 +340,127 @@ static void CompressionFunction(uint32_t *pui32Hash, const uint32_t *pui32Messag
     memcpy(pui32Hash, ui32Ciphertext, sizeof(ui32Ciphertext));
 }
 
+#if defined(CHIMA_X86_DISPATCH)
+/**
+ * @brief Função de compressão do Lesamnta-LW com AES-NI.
+ *
+ * A etapa Q é SubBytes seguido de MixColumns sobre uma palavra vista como
+ * coluna do AES (byte mais significativo primeiro). AESENC com chave nula
+ * faz exatamente isso quando a entrada já passou por InvShiftRows, então
+ * um pshufb inverte os bytes de cada palavra e desfaz o ShiftRows antes,
+ * e outro devolve as palavras depois. O escalonamento de chaves e a
+ * mistura de mensagem correm na mesma iteração: as três etapas Q de uma
+ * rodada (uma da chave, duas da função G) saem de uma única instrução.
+ *
+ * @param pui32Hash    Vetor do hash em palavras
+ * @param pui32Message Bloco de mensagem
+ */
+static CHIMA_TARGET("aes,ssse3") void CompressionFunctionAESNI(uint32_t *pui32Hash, const uint32_t *pui32Message)
+{
+    const __m128i xPre  = _mm_setr_epi8(3, 14, 9, 4, 7, 2, 13, 8, 11, 6, 1, 12, 15, 10, 5, 0);
+    const __m128i xPost = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    uint32_t ui32K[KeyLengthInWord], ui32Block[BlockLengthInWord], ui32Q[4];
+    uint32_t ui32Buf0, ui32Buf1, ui32Next;
+    __m128i xQ;
+
+    memcpy(ui32K, pui32Hash, sizeof(ui32K));
+    memcpy(ui32Block, pui32Message, sizeof(ui32Block) / 2);
+    memcpy(ui32Block + 4, pui32Hash + 4, sizeof(ui32Block) / 2);
+
+    for (uint32_t uRound = 0; uRound < NumberOfRounds; uRound++) {
+        xQ = _mm_setr_epi32((int)(C[uRound] ^ ui32K[2]), (int)(ui32Block[4] ^ ui32K[0]), (int)ui32Block[5], 0);
+        xQ = _mm_shuffle_epi8(_mm_aesenc_si128(_mm_shuffle_epi8(xQ, xPre), _mm_setzero_si128()), xPost);
+        _mm_storeu_si128((__m128i *)ui32Q, xQ);
+
+        // KeySchedule
+        ui32Next = ui32Q[0] ^ ui32K[3];
+        ui32K[3] = ui32K[2];
+        ui32K[2] = ui32K[1];
+        ui32K[1] = ui32K[0];
+        ui32K[0] = ui32Next;
+
+        // FunctionR e MessageMixing
+        ui32Buf0 = ((ui32Q[1] & 0xFFFF0000U) | (ui32Q[2] & 0x0000FFFFU)) ^ ui32Block[7];
+        ui32Buf1 = ((ui32Q[2] & 0xFFFF0000U) | (ui32Q[1] & 0x0000FFFFU)) ^ ui32Block[6];
+        ui32Block[7] = ui32Block[5];
+        ui32Block[6] = ui32Block[4];
+        ui32Block[5] = ui32Block[3];
+        ui32Block[4] = ui32Block[2];
+        ui32Block[3] = ui32Block[1];
+        ui32Block[2] = ui32Block[0];
+        ui32Block[1] = ui32Buf0;
+        ui32Block[0] = ui32Buf1;
+    }
+
+    memcpy(pui32Hash, ui32Block, sizeof(ui32Block));
+}
+#endif
+
 /**
- * @brief Processa dados de entrada em blocos.
+ * @brief Escolhe a função de compressão do Lesamnta-LW.
+ *
+ * @param pDispatch Tabela em construção, com ui32Features preenchido
+ */
+void CHIMA_BindLesamnta(CHIMA_Dispatch *pDispatch)
+{
+    pDispatch->pfnLesamntaCompress = CompressionFunctionPortable;
+#if defined(CHIMA_X86_DISPATCH)
+    if ((pDispatch->ui32Features & (CHIMA_CPU_AESNI | CHIMA_CPU_SSSE3)) == (CHIMA_CPU_AESNI | CHIMA_CPU_SSSE3))
+        pDispatch->pfnLesamntaCompress = CompressionFunctionAESNI;
+#endif
+}
+
+/**
+ * @brief Função de compressão do Lesamnta-LW.
+ *
+ * @param pui32Hash    Vetor do hash em palavras
+ * @param pui32Message Bloco de mensagem
+ */
+static void CompressionFunction(uint32_t *pui32Hash, const uint32_t *pui32Message)
+{
+    CHIMA_GetDispatch()->pfnLesamntaCompress(pui32Hash, pui32Message);
+}
+
+/**
+ * @brief Processa mais dados da mensagem.
+ *
+ * Pode ser chamada várias vezes; só a última chamada antes do Final pode
+ * ter um comprimento que não seja múltiplo de 8 bits.
  *
  * @param pState        Estado interno
  * @param pcData        Dados de entrada
  * @param dlDataBitLen  Tamanho em bits
  * @return Código de erro
  */
-static HashReturn LesamntaLW_Update(hashState *pState, const BitSequence *pcData, DataLength dlDataBitLen)
+HashReturn LesamntaLW_Update(hashState *pState, const BitSequence *pcData, DataLength dlDataBitLen)
 {
-    pState->ui32MessageLength[0] = (uint32_t)(dlDataBitLen >> 32);
-    pState->ui32MessageLength[1] = (uint32_t)dlDataBitLen;
+    DataLength dlTotal = (((DataLength)pState->ui32MessageLength[0] << 32) | pState->ui32MessageLength[1]) + dlDataBitLen;
+    uint32_t i;
+
+    if (pState->ui32RemainingLength % 8 != 0)
+        return FAIL;
+    pState->ui32MessageLength[0] = (uint32_t)(dlTotal >> 32);
+    pState->ui32MessageLength[1] = (uint32_t)dlTotal;
+
+    // Completa o bloco parcial deixado pela chamada anterior
+    while (pState->ui32RemainingLength != 0 && dlDataBitLen > 0) {
+        i = pState->ui32RemainingLength / 8;
+        pState->ui32Message[i / 4] |= ((uint32_t)*pcData) << (24 - 8 * (i % 4));
+        if (dlDataBitLen < 8) {
+            pState->ui32RemainingLength += (uint32_t)dlDataBitLen;
+            return SUCCESS_;
+        }
+        pcData++;
+        dlDataBitLen -= 8;
+        pState->ui32RemainingLength += 8;
+        if (pState->ui32RemainingLength == MessageBlockLengthInBit) {
+            CompressionFunction(pState->ui32Hash, pState->ui32Message);
+            memset(pState->ui32Message, 0, MessageBlockLengthInByte);
+            pState->ui32RemainingLength = 0;
+        }
+    }
+    if (dlDataBitLen == 0)
+        return SUCCESS_;
 
     while (dlDataBitLen >= MessageBlockLengthInBit) {
     	SetMessage(pState->ui32Message, pcData);
@@ -371,7 +469,7 @@ static HashReturn LesamntaLW_Update(hashState *pState, const BitSequence *pcData
         dlDataBitLen -= MessageBlockLengthInBit;
     }
 
-    pState->ui32RemainingLength = dlDataBitLen;
+    pState->ui32RemainingLength = (uint32_t)dlDataBitLen;
     memset(pState->ui32Message, 0, MessageBlockLengthInByte);
     if (pState->ui32RemainingLength != 0)
     	SetRemainingMessage(pState->ui32Message, pState->ui32RemainingLength, pcData);
@@ -414,7 +512,7 @@ static void ToBitSequence256(BitSequence *pcHashVal, const uint32_t *pui32Hash)
  * @param pcHashVal Buffer de saída do hash
  * @return Código de erro
  */
-static HashReturn LesamntaLW_Final(hashState *pState, BitSequence *pcHashVal)
+HashReturn LesamntaLW_Final(hashState *pState, BitSequence *pcHashVal)
 {
     if (pState->ui32RemainingLength == 0)
         pState->ui32Message[0] = 0x80000000U;
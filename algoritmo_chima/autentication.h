@@ -30,6 +30,18 @@ typedef enum {
 typedef unsigned char BitSequence;
 typedef uint64_t DataLength;
 
+/**
+ * @brief Estado interno do hash
+ *
+ */
+typedef struct {
+    int iHashBitLen;
+    uint32_t ui32MessageLength[2];
+    uint32_t ui32RemainingLength;
+    uint32_t ui32Message[4];
+    uint32_t ui32Hash[8];
+} hashState;
+
 
 // PROTÓTIPOS DE FUNÇÃO //
 
@@ -43,5 +55,16 @@ typedef uint64_t DataLength;
  */
 HashReturn LesamntaLW_Hash(const BitSequence *pcData, DataLength dlDataBitLen, BitSequence *pcHashVal);
 
+/*
+ * Cálculo incremental: Init, uma ou mais chamadas a Update e Final. O
+ * resultado é o mesmo de LesamntaLW_Hash sobre os dados concatenados.
+ * Só a última chamada a Update pode ter comprimento que não seja múltiplo
+ * de 8 bits.
+ */
+
+HashReturn LesamntaLW_Init(hashState *pState);
+HashReturn LesamntaLW_Update(hashState *pState, const BitSequence *pcData, DataLength dlDataBitLen);
+HashReturn LesamntaLW_Final(hashState *pState, BitSequence *pcHashVal);
+
 
 #endif /* AUTENTICATION_H */
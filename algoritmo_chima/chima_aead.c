@@ -0,0 +1,433 @@
+/**
+ * @file chima_aead.c
+ * @author
+ * @brief Cifragem autenticada: CTR com Lesamnta-LW e CTR com GHASH (GCM).
+ * @version
+ * @date 2025-06-13
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * O contador é o nonce seguido de 32 bits que começam em 1, como no GCM:
+ * os primeiros blocos do fluxo viram as duas chaves de autenticação e os
+ * dados usam os contadores seguintes. Como o nonce nunca é incrementado,
+ * nonces vizinhos não compartilham fluxo. A etiqueta é
+ *
+ *   H(Kext || H(Kint || AD || 0* || C || 0* || |AD| || |C|))
+ *
+ * truncada em CHIMA_AEAD_TAG_BYTES, com H = Lesamnta-LW, os preenchimentos
+ * completando blocos de 16 bytes e os tamanhos em bytes como inteiros
+ * big-endian de 64 bits. O hash externo impede a extensão de comprimento
+ * que a construção Merkle-Damgård permitiria com apenas a chave prefixada.
+ *
+ * O modo GCM troca o Lesamnta-LW pelo GHASH, cuja chave H é fixa por
+ * contexto; o custo de autenticação fica em uma multiplicação sem carry
+ * por bloco de 16 bytes.
+ *
+ * Na cifragem, cada parte de AEAD_CHUNK bytes é cifrada e em seguida
+ * passada ao hash enquanto ainda está no cache L1.
+ */
+
+
+// INCLUSÕES //
+
+#include "chima_aead.h"
+#include "autentication.h"
+#include "chima_kernels.h"
+#include <string.h>
+
+
+// DEFINIÇÕES //
+
+/** Bytes cifrados e autenticados por vez (múltiplo de 16, cabe no L1) */
+#define AEAD_CHUNK      4096
+/** Tamanho de cada chave de autenticação, em bytes (um bloco do hash) */
+#define MAC_KEY_BYTES   16
+/** Último valor da parte de 32 bits do contador */
+#define CTR32_MAX_COUNTER 0xFFFFFFFFULL
+
+
+// TIPOS //
+
+/** Chaves derivadas do nonce e contador dos dados */
+typedef struct {
+    uint8_t aucCounter[16];           /**< Próximo contador CTR */
+    uint8_t aucInner[MAC_KEY_BYTES];  /**< Chave do hash interno */
+    uint8_t aucOuter[MAC_KEY_BYTES];  /**< Chave do hash externo */
+} AeadKeys;
+
+
+// FUNÇÕES //
+
+/**
+ * @brief Deriva as chaves de autenticação dos primeiros blocos do fluxo.
+ *
+ * @param pCtx  Contexto com as chaves
+ * @param nonce Nonce (tamanho do bloco menos 4 bytes)
+ * @param pKeys Recebe as chaves e o contador dos dados
+ */
+static void Derive_Keys(const CHIMA_Ctx *pCtx, const uint8_t *nonce, AeadKeys *pKeys) {
+    static const uint8_t aucZero[2 * MAC_KEY_BYTES] = {0};
+    uint32_t bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    uint8_t aucStream[2 * MAC_KEY_BYTES];
+
+    memcpy(pKeys->aucCounter, nonce, bs - 4);
+    memset(pKeys->aucCounter + bs - 4, 0, 3);
+    pKeys->aucCounter[bs - 1] = 1;
+    CHIMA_EncryptCTR_Buf(pCtx, aucZero, aucStream, sizeof(aucStream) / bs, pKeys->aucCounter);
+    memcpy(pKeys->aucInner, aucStream, MAC_KEY_BYTES);
+    memcpy(pKeys->aucOuter, aucStream + MAC_KEY_BYTES, MAC_KEY_BYTES);
+    SecureZero(aucStream, sizeof(aucStream));
+}
+
+/**
+ * @brief Aplica o fluxo CTR a len bytes; um bloco final incompleto usa
+ * só o início do fluxo.
+ *
+ * @param pCtx    Contexto com as chaves
+ * @param in      Entrada
+ * @param out     Saída (pode ser igual a in)
+ * @param len     Tamanho em bytes
+ * @param counter Contador; avança um por bloco usado
+ */
+static void Ctr_Xor(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t len, uint8_t *counter) {
+    uint32_t bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    size_t nblocks = len / bs, rem = len % bs;
+    uint8_t block[16] = {0};
+
+    if (nblocks > 0)
+        CHIMA_EncryptCTR_Buf(pCtx, in, out, nblocks, counter);
+    if (rem > 0) {
+        memcpy(block, in + nblocks * bs, rem);
+        CHIMA_EncryptCTR_Buf(pCtx, block, block, 1, counter);
+        memcpy(out + nblocks * bs, block, rem);
+        SecureZero(block, sizeof(block));
+    }
+}
+
+/**
+ * @brief Passa bytes ao hash.
+ */
+static void Mac_Update(hashState *pState, const uint8_t *data, size_t len) {
+    LesamntaLW_Update(pState, data, (DataLength)len * 8);
+}
+
+/**
+ * @brief Completa com zeros o bloco de 16 bytes do hash.
+ *
+ * @param pState Estado do hash
+ * @param len    Bytes passados desde o último alinhamento
+ */
+static void Mac_Pad(hashState *pState, size_t len) {
+    static const uint8_t aucZero[16] = {0};
+
+    if (len % 16 != 0)
+        Mac_Update(pState, aucZero, 16 - len % 16);
+}
+
+/**
+ * @brief Inicia o hash interno com a chave e os dados associados.
+ */
+static void Mac_Begin(hashState *pState, const AeadKeys *pKeys, const uint8_t *ad, size_t adlen) {
+    LesamntaLW_Init(pState);
+    Mac_Update(pState, pKeys->aucInner, MAC_KEY_BYTES);
+    Mac_Update(pState, ad, adlen);
+    Mac_Pad(pState, adlen);
+}
+
+/**
+ * @brief Encerra o hash interno e calcula a etiqueta.
+ *
+ * @param pState Estado do hash interno (com AD e texto cifrado)
+ * @param pKeys  Chaves de autenticação
+ * @param adlen  Tamanho dos dados associados
+ * @param len    Tamanho do texto cifrado
+ * @param tag    Recebe CHIMA_AEAD_TAG_BYTES bytes
+ */
+static void Mac_End(hashState *pState, const AeadKeys *pKeys, size_t adlen, size_t len, uint8_t *tag) {
+    uint8_t aucLens[16], aucHash[LESAMNTALW_HASH_BITLENGTH / 8];
+    uint64_t ui64Ad = adlen, ui64Len = len;
+
+    Mac_Pad(pState, len);
+    for (int i = 0; i < 8; i++) {
+        aucLens[i]     = (uint8_t)(ui64Ad >> (56 - 8 * i));
+        aucLens[8 + i] = (uint8_t)(ui64Len >> (56 - 8 * i));
+    }
+    Mac_Update(pState, aucLens, sizeof(aucLens));
+    LesamntaLW_Final(pState, aucHash);
+
+    LesamntaLW_Init(pState);
+    Mac_Update(pState, pKeys->aucOuter, MAC_KEY_BYTES);
+    Mac_Update(pState, aucHash, sizeof(aucHash));
+    LesamntaLW_Final(pState, aucHash);
+
+    memcpy(tag, aucHash, CHIMA_AEAD_TAG_BYTES);
+    SecureZero(aucHash, sizeof(aucHash));
+    SecureZero(pState, sizeof(*pState));
+}
+
+/**
+ * @brief Confere os parâmetros comuns do AEAD.
+ *
+ * Os dados não podem levar a parte de 32 bits do contador além do último
+ * valor, onde ela voltaria a zero e atingiria o nonce.
+ */
+static int Aead_Check(const CHIMA_Ctx *pCtx, const uint8_t *nonce, const uint8_t *ad, size_t adlen,
+     const uint8_t *in, size_t len, const uint8_t *out, const uint8_t *tag) {
+    uint32_t bs;
+
+    if (pCtx == NULL || nonce == NULL || tag == NULL || (ad == NULL && adlen > 0) || ((in == NULL || out == NULL) && len > 0))
+        return -1;
+    bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    if ((uint64_t)(len / bs) + (len % bs != 0) > CTR32_MAX_COUNTER - 2 * MAC_KEY_BYTES / bs)
+        return -1;
+    return 0;
+}
+
+/**
+ * @brief Cifra e autentica.
+ *
+ * @param pCtx  Contexto com as chaves
+ * @param nonce Nonce (tamanho do bloco menos 4 bytes), único por mensagem
+ * @param ad    Dados associados (autenticados, não cifrados)
+ * @param adlen Tamanho dos dados associados
+ * @param in    Dados claros
+ * @param len   Tamanho em bytes
+ * @param out   Texto cifrado (len bytes; pode ser igual a in)
+ * @param tag   Recebe CHIMA_AEAD_TAG_BYTES bytes
+ * @return 0 em caso de sucesso, -1 em erro
+ */
+int CHIMA_AeadEncrypt(const CHIMA_Ctx *pCtx, const uint8_t *nonce, const uint8_t *ad, size_t adlen,
+     const uint8_t *in, size_t len, uint8_t *out, uint8_t *tag) {
+    AeadKeys xKeys;
+    hashState xState;
+    size_t n;
+
+    if (Aead_Check(pCtx, nonce, ad, adlen, in, len, out, tag) != 0)
+        return -1;
+
+    Derive_Keys(pCtx, nonce, &xKeys);
+    Mac_Begin(&xState, &xKeys, ad, adlen);
+    for (size_t off = 0; off < len; off += n) {
+        n = (len - off < AEAD_CHUNK) ? len - off : AEAD_CHUNK;
+        Ctr_Xor(pCtx, in + off, out + off, n, xKeys.aucCounter);
+        Mac_Update(&xState, out + off, n);
+    }
+    Mac_End(&xState, &xKeys, adlen, len, tag);
+
+    SecureZero(&xKeys, sizeof(xKeys));
+    return 0;
+}
+
+/**
+ * @brief Confere a etiqueta e decifra.
+ *
+ * @param pCtx  Contexto com as chaves
+ * @param nonce Nonce usado na cifragem
+ * @param ad    Dados associados
+ * @param adlen Tamanho dos dados associados
+ * @param in    Texto cifrado
+ * @param len   Tamanho em bytes
+ * @param tag   Etiqueta recebida (CHIMA_AEAD_TAG_BYTES bytes)
+ * @param out   Dados claros (len bytes; pode ser igual a in)
+ * @return 0 em caso de sucesso, -1 se a etiqueta não conferir ou em erro
+ */
+int CHIMA_AeadDecrypt(const CHIMA_Ctx *pCtx, const uint8_t *nonce, const uint8_t *ad, size_t adlen,
+     const uint8_t *in, size_t len, const uint8_t *tag, uint8_t *out) {
+    AeadKeys xKeys;
+    hashState xState;
+    uint8_t aucTag[CHIMA_AEAD_TAG_BYTES], ucDiff = 0;
+
+    if (Aead_Check(pCtx, nonce, ad, adlen, in, len, out, tag) != 0)
+        return -1;
+
+    Derive_Keys(pCtx, nonce, &xKeys);
+    Mac_Begin(&xState, &xKeys, ad, adlen);
+    Mac_Update(&xState, in, len);
+    Mac_End(&xState, &xKeys, adlen, len, aucTag);
+
+    // Comparação em tempo constante
+    for (int i = 0; i < CHIMA_AEAD_TAG_BYTES; i++)
+        ucDiff |= aucTag[i] ^ tag[i];
+
+    if (ucDiff == 0)
+        Ctr_Xor(pCtx, in, out, len, xKeys.aucCounter);
+
+    SecureZero(&xKeys, sizeof(xKeys));
+    SecureZero(aucTag, sizeof(aucTag));
+    return (ucDiff == 0) ? 0 : -1;
+}
+
+/**
+ * @brief Prepara o contexto GCM.
+ *
+ * @param pGcm Contexto GCM
+ * @param pCtx Contexto com as chaves da cifra
+ * @return 0 em caso de sucesso, -1 se os parâmetros forem inválidos
+ */
+int CHIMA_GcmInit(CHIMA_GcmCtx *pGcm, const CHIMA_Ctx *pCtx) {
+    uint8_t aucH[16] = {0};
+
+    if (pGcm == NULL || pCtx == NULL)
+        return -1;
+
+    pGcm->pCtx = pCtx;
+    if (pCtx->xSize == BLOCK_MODE_64) {
+        // Os 32 bits baixos nulos nunca aparecem em um contador
+        aucH[11] = 1;
+        CHIMA_EncryptECB_Buf(pCtx, aucH, aucH, 2);
+    } else {
+        CHIMA_EncryptECB_Buf(pCtx, aucH, aucH, 1);
+    }
+    CHIMA_GhashSetKey(&pGcm->xHash, aucH);
+    SecureZero(aucH, sizeof(aucH));
+    return 0;
+}
+
+/**
+ * @brief Apaga o contexto GCM.
+ *
+ * @param pGcm Contexto GCM
+ */
+void CHIMA_GcmFree(CHIMA_GcmCtx *pGcm) {
+    if (pGcm != NULL)
+        SecureZero(pGcm, sizeof(*pGcm));
+}
+
+/**
+ * @brief Passa bytes ao GHASH, completando com zeros o último bloco.
+ *
+ * @param pucX Acumulador
+ * @param pKey Chave do GHASH
+ * @param data Dados
+ * @param len  Tamanho em bytes
+ */
+static void Ghash_Update(uint8_t *pucX, const CHIMA_GhashKey *pKey, const uint8_t *data, size_t len) {
+    const CHIMA_Dispatch *pDispatch = CHIMA_GetDispatch();
+    uint8_t block[16] = {0};
+
+    if (len >= 16)
+        pDispatch->pfnGhash(pucX, pKey, data, len / 16);
+    if (len % 16 != 0) {
+        memcpy(block, data + len - len % 16, len % 16);
+        pDispatch->pfnGhash(pucX, pKey, block, 1);
+    }
+}
+
+/**
+ * @brief Gera a máscara da etiqueta e o contador dos dados.
+ *
+ * @param pCtx    Contexto com as chaves
+ * @param nonce   Nonce (tamanho do bloco menos 4 bytes)
+ * @param pucMask Recebe os 16 bytes que mascaram a etiqueta
+ * @param counter Recebe o contador do primeiro bloco de dados
+ */
+static void Gcm_Start(const CHIMA_Ctx *pCtx, const uint8_t *nonce, uint8_t *pucMask, uint8_t *counter) {
+    static const uint8_t aucZero[16] = {0};
+    uint32_t bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+
+    memcpy(counter, nonce, bs - 4);
+    memset(counter + bs - 4, 0, 3);
+    counter[bs - 1] = 1;
+    CHIMA_EncryptCTR_Buf(pCtx, aucZero, pucMask, 16 / bs, counter);
+}
+
+/**
+ * @brief Encerra o GHASH com os tamanhos e aplica a máscara.
+ */
+static void Gcm_Tag(uint8_t *pucX, const CHIMA_GhashKey *pKey, size_t adlen, size_t len, const uint8_t *pucMask, uint8_t *tag) {
+    uint8_t aucLens[16];
+    uint64_t ui64Ad = (uint64_t)adlen * 8, ui64Len = (uint64_t)len * 8;
+
+    for (int i = 0; i < 8; i++) {
+        aucLens[i]     = (uint8_t)(ui64Ad >> (56 - 8 * i));
+        aucLens[8 + i] = (uint8_t)(ui64Len >> (56 - 8 * i));
+    }
+    CHIMA_GetDispatch()->pfnGhash(pucX, pKey, aucLens, 1);
+    XOR_Blocks(tag, pucX, pucMask, CHIMA_GCM_TAG_BYTES);
+}
+
+/**
+ * @brief Confere os parâmetros comuns do GCM.
+ */
+static int Gcm_Check(const CHIMA_GcmCtx *pGcm, const uint8_t *nonce, const uint8_t *ad, size_t adlen,
+     const uint8_t *in, size_t len, const uint8_t *out, const uint8_t *tag) {
+    uint32_t bs;
+
+    if (pGcm == NULL || pGcm->pCtx == NULL || nonce == NULL || tag == NULL || (ad == NULL && adlen > 0) || ((in == NULL || out == NULL) && len > 0))
+        return -1;
+    bs = (pGcm->pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    if ((uint64_t)(len / bs) + (len % bs != 0) > CTR32_MAX_COUNTER - 16 / bs)
+        return -1;
+    return 0;
+}
+
+/**
+ * @brief Cifra e autentica no modo GCM.
+ *
+ * @param pGcm  Contexto GCM
+ * @param nonce Nonce (tamanho do bloco menos 4 bytes), único por mensagem
+ * @param ad    Dados associados (autenticados, não cifrados)
+ * @param adlen Tamanho dos dados associados
+ * @param in    Dados claros
+ * @param len   Tamanho em bytes
+ * @param out   Texto cifrado (len bytes; pode ser igual a in)
+ * @param tag   Recebe CHIMA_GCM_TAG_BYTES bytes
+ * @return 0 em caso de sucesso, -1 em erro
+ */
+int CHIMA_GcmEncrypt(const CHIMA_GcmCtx *pGcm, const uint8_t *nonce, const uint8_t *ad, size_t adlen,
+     const uint8_t *in, size_t len, uint8_t *out, uint8_t *tag) {
+    uint8_t aucMask[16], aucX[16] = {0}, counter[16];
+    size_t n;
+
+    if (Gcm_Check(pGcm, nonce, ad, adlen, in, len, out, tag) != 0)
+        return -1;
+
+    Gcm_Start(pGcm->pCtx, nonce, aucMask, counter);
+    Ghash_Update(aucX, &pGcm->xHash, ad, adlen);
+    for (size_t off = 0; off < len; off += n) {
+        n = (len - off < AEAD_CHUNK) ? len - off : AEAD_CHUNK;
+        Ctr_Xor(pGcm->pCtx, in + off, out + off, n, counter);
+        Ghash_Update(aucX, &pGcm->xHash, out + off, n);
+    }
+    Gcm_Tag(aucX, &pGcm->xHash, adlen, len, aucMask, tag);
+
+    SecureZero(aucMask, sizeof(aucMask));
+    return 0;
+}
+
+/**
+ * @brief Confere a etiqueta e decifra no modo GCM.
+ *
+ * @param pGcm  Contexto GCM
+ * @param nonce Nonce usado na cifragem
+ * @param ad    Dados associados
+ * @param adlen Tamanho dos dados associados
+ * @param in    Texto cifrado
+ * @param len   Tamanho em bytes
+ * @param tag   Etiqueta recebida (CHIMA_GCM_TAG_BYTES bytes)
+ * @param out   Dados claros (len bytes; pode ser igual a in)
+ * @return 0 em caso de sucesso, -1 se a etiqueta não conferir ou em erro
+ */
+int CHIMA_GcmDecrypt(const CHIMA_GcmCtx *pGcm, const uint8_t *nonce, const uint8_t *ad, size_t adlen,
+     const uint8_t *in, size_t len, const uint8_t *tag, uint8_t *out) {
+    uint8_t aucMask[16], aucX[16] = {0}, aucTag[CHIMA_GCM_TAG_BYTES], counter[16], ucDiff = 0;
+
+    if (Gcm_Check(pGcm, nonce, ad, adlen, in, len, out, tag) != 0)
+        return -1;
+
+    Gcm_Start(pGcm->pCtx, nonce, aucMask, counter);
+    Ghash_Update(aucX, &pGcm->xHash, ad, adlen);
+    Ghash_Update(aucX, &pGcm->xHash, in, len);
+    Gcm_Tag(aucX, &pGcm->xHash, adlen, len, aucMask, aucTag);
+
+    // Comparação em tempo constante
+    for (int i = 0; i < CHIMA_GCM_TAG_BYTES; i++)
+        ucDiff |= aucTag[i] ^ tag[i];
+
+    if (ucDiff == 0)
+        Ctr_Xor(pGcm->pCtx, in, out, len, counter);
+
+    SecureZero(aucMask, sizeof(aucMask));
+    SecureZero(aucTag, sizeof(aucTag));
+    return (ucDiff == 0) ? 0 : -1;
+}
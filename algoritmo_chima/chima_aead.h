@@ -0,0 +1,121 @@
+/**
+ * @file chima_aead.h
+ * @author
+ * @brief Cifragem autenticada: CTR com Lesamnta-LW e CTR com GHASH (GCM).
+ * @version
+ * @date 2025-06-13
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef CHIMA_AEAD_H
+#define CHIMA_AEAD_H
+
+
+// INCLUSÕES //
+
+#include "chima_crypto.h"
+
+
+// DEFINIÇÕES //
+
+/** Tamanho da etiqueta de autenticação, em bytes */
+#define CHIMA_AEAD_TAG_BYTES 16
+/** Tamanho da etiqueta do modo GCM, em bytes */
+#define CHIMA_GCM_TAG_BYTES  16
+
+
+// TIPOS //
+
+/**
+ * @brief Chave do GHASH (multiplicação por H em GF(2^128)) pré-calculada.
+ */
+typedef struct {
+    uint64_t aui64HL[16];    /**< Múltiplos de H por nibble, metade baixa (tabela) */
+    uint64_t aui64HH[16];    /**< Múltiplos de H por nibble, metade alta (tabela) */
+    uint8_t  aucHPow[4][16]; /**< H, H^2, H^3 e H^4 com os bytes invertidos (PCLMUL) */
+} CHIMA_GhashKey;
+
+/**
+ * @brief Contexto do modo GCM: chaves da cifra e do GHASH.
+ */
+typedef struct {
+    const CHIMA_Ctx *pCtx;  /**< Contexto com as chaves da cifra */
+    CHIMA_GhashKey   xHash; /**< Chave do GHASH derivada de pCtx */
+} CHIMA_GcmCtx;
+
+
+// PROTÓTIPOS DE FUNÇÃO //
+
+/*
+ * Os dados são cifrados em CTR e o texto cifrado, junto com os dados
+ * associados, é autenticado com Lesamnta-LW. As chaves de autenticação são
+ * derivadas da chave do contexto e do nonce, então o mesmo contexto serve
+ * para as duas funções.
+ *
+ * O contador CTR é o nonce seguido de 32 bits que começam em 1: os
+ * primeiros 32 bytes do fluxo são as chaves de autenticação e os seguintes
+ * cifram os dados. O nonce tem o tamanho do bloco menos 4 bytes (12 ou 4
+ * bytes) e não pode se repetir sob a mesma chave; um contador de mensagens
+ * serve. Cada mensagem tem no máximo 2^32 - 3 blocos da cifra (2^32 - 5
+ * com blocos de 64 bits).
+ *
+ * out pode ser igual a in. A decifração confere a etiqueta antes de gerar
+ * qualquer byte claro: se ela não confere, out não é alterado.
+ *
+ * Retornam 0 em caso de sucesso e -1 se os parâmetros forem inválidos ou,
+ * na decifração, se a etiqueta não conferir.
+ */
+
+int CHIMA_AeadEncrypt(const CHIMA_Ctx *pCtx, const uint8_t *nonce, const uint8_t *ad, size_t adlen,
+     const uint8_t *in, size_t len, uint8_t *out, uint8_t *tag);
+int CHIMA_AeadDecrypt(const CHIMA_Ctx *pCtx, const uint8_t *nonce, const uint8_t *ad, size_t adlen,
+     const uint8_t *in, size_t len, const uint8_t *tag, uint8_t *out);
+
+/**
+ * @brief Prepara o contexto GCM.
+ *
+ * H é a cifra do bloco nulo (com blocos de 64 bits, a concatenação das
+ * cifras de dois blocos cujos 32 bits baixos são nulos, que nunca são
+ * contadores). O contexto da cifra deve continuar válido enquanto o
+ * contexto GCM for usado.
+ *
+ * @param pGcm Contexto GCM
+ * @param pCtx Contexto com as chaves da cifra
+ * @return 0 em caso de sucesso, -1 se os parâmetros forem inválidos
+ */
+int CHIMA_GcmInit(CHIMA_GcmCtx *pGcm, const CHIMA_Ctx *pCtx);
+
+/**
+ * @brief Apaga o contexto GCM.
+ *
+ * @param pGcm Contexto GCM
+ */
+void CHIMA_GcmFree(CHIMA_GcmCtx *pGcm);
+
+/*
+ * Modo de contador com GHASH, como no GCM: o contador é o nonce seguido
+ * de 32 bits que começam em 1, o primeiro bloco do fluxo (os dois
+ * primeiros com blocos de 64 bits) mascara a etiqueta e os seguintes
+ * cifram os dados. O GHASH cobre os dados associados e o texto cifrado,
+ * cada um completado com zeros até 16 bytes, e os tamanhos em bits. Com
+ * blocos de 128 bits o resultado é o do GCM com a CHIMA no lugar do AES.
+ *
+ * O nonce tem o tamanho do bloco menos 4 bytes (12 ou 4 bytes) e não pode
+ * se repetir sob a mesma chave; com blocos de 64 bits convém usar um
+ * contador de mensagens. Cada mensagem tem no máximo 2^32 - 2 blocos da
+ * cifra (2^32 - 3 com blocos de 64 bits).
+ *
+ * out pode ser igual a in. A decifração confere a etiqueta antes de gerar
+ * qualquer byte claro. Retornam 0 em caso de sucesso e -1 se os
+ * parâmetros forem inválidos ou a etiqueta não conferir.
+ */
+
+int CHIMA_GcmEncrypt(const CHIMA_GcmCtx *pGcm, const uint8_t *nonce, const uint8_t *ad, size_t adlen,
+     const uint8_t *in, size_t len, uint8_t *out, uint8_t *tag);
+int CHIMA_GcmDecrypt(const CHIMA_GcmCtx *pGcm, const uint8_t *nonce, const uint8_t *ad, size_t adlen,
+     const uint8_t *in, size_t len, const uint8_t *tag, uint8_t *out);
+
+
+#endif /* CHIMA_AEAD_H */
@@ -0,0 +1,294 @@
+/**
+ * @file chima_aesni.c
+ * @author
+ * @brief Núcleo AES-NI da rede Feistel para poucos blocos simultâneos.
+ * @version
+ * @date 2025-06-13
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * AESENCLAST com chave de rodada nula aplica ShiftRows e SubBytes aos 16
+ * bytes do registrador; um pshufb fixo desfaz o ShiftRows e sobra apenas
+ * a S-Box do AES. Assim as metades direitas de 4 blocos (modo de 64 bits)
+ * ou de 2 blocos (modo de 128 bits) passam pela S-Box em uma instrução.
+ * A permutação usa PDEP (BMI2); o despacho só escolhe este núcleo quando
+ * o processador tem as três extensões.
+ *
+ * Nenhuma das duas etapas depende de tabelas pré-calculadas a partir da
+ * chave, então a variante com várias chaves só precisa carregar a chave de
+ * rodada de cada via.
+ */
+
+
+// INCLUSÕES //
+
+#include "chima_kernels.h"
+#include "utils.h"
+
+#if defined(CHIMA_HAVE_AESNI)
+
+
+// FUNÇÕES //
+
+/**
+ * @brief Cifra ou decifra grupos de 4 blocos com AES-NI.
+ *
+ * A decifração é a mesma rodada com as metades trocadas e as chaves em
+ * ordem inversa.
+ *
+ * @param pCtx    Contexto
+ * @param in      Blocos de entrada
+ * @param out     Blocos de saída
+ * @param n       Quantidade de blocos
+ * @param decrypt 0 para cifrar, 1 para decifrar
+ * @return Quantidade de blocos processados
+ */
+static CHIMA_TARGET("bmi2,aes,ssse3") size_t Feistel_Blocks_AESNI(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t n, int decrypt) {
+    uint32_t bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    size_t groups = n / CHIMA_AESNI_LANES;
+    uint32_t rounds = pCtx->ui32NumRounds, words[4];
+    const uint32_t *rk = pCtx->aui32RoundKeys;
+    uint32_t r;
+
+    for (size_t g = 0; g < groups; g++, in += CHIMA_AESNI_LANES * bs, out += CHIMA_AESNI_LANES * bs) {
+        if (pCtx->xSize == BLOCK_MODE_64) {
+            uint32_t aL[CHIMA_AESNI_LANES], aR[CHIMA_AESNI_LANES], aS[CHIMA_AESNI_LANES], t;
+            __m128i v;
+
+            for (int j = 0; j < CHIMA_AESNI_LANES; j++) {
+                BlockFromBytes(in + j * bs, words, BLOCK_MODE_64);
+                aL[j] = decrypt ? words[1] : words[0];
+                aR[j] = decrypt ? words[0] : words[1];
+            }
+
+            for (uint32_t k = 0; k < rounds; k++) {
+                r = decrypt ? rounds - 1 - k : k;
+                v = _mm_xor_si128(_mm_loadu_si128((const __m128i *)aR), _mm_set1_epi32((int)rk[2 * r]));
+                _mm_storeu_si128((__m128i *)aS, CHIMA_AESNI_SBox(v));
+                for (int j = 0; j < CHIMA_AESNI_LANES; j++) {
+                    t = aR[j];
+                    aR[j] = aL[j] ^ (uint32_t)CHIMA_BMI2_Permute(aS[j], rk[2 * r + 1], 32);
+                    aL[j] = t;
+                }
+            }
+
+            for (int j = 0; j < CHIMA_AESNI_LANES; j++) {
+                words[0] = decrypt ? aR[j] : aL[j];
+                words[1] = decrypt ? aL[j] : aR[j];
+                BlockToBytes(words, out + j * bs, BLOCK_MODE_64);
+            }
+        } else {
+            uint64_t aL[CHIMA_AESNI_LANES], aR[CHIMA_AESNI_LANES], aS[CHIMA_AESNI_LANES], half[2], K, t;
+            __m128i key;
+
+            for (int j = 0; j < CHIMA_AESNI_LANES; j++) {
+                BlockFromBytes(in + j * bs, words, BLOCK_MODE_128);
+                half[0] = ((uint64_t)words[0] << 32) | words[1];
+                half[1] = ((uint64_t)words[2] << 32) | words[3];
+                aL[j] = half[decrypt];
+                aR[j] = half[!decrypt];
+            }
+
+            for (uint32_t k = 0; k < rounds; k++) {
+                r = decrypt ? rounds - 1 - k : k;
+                K = ((uint64_t)rk[2 * r] << 32) | rk[2 * r + 1];
+                key = _mm_set1_epi64x((long long)K);
+                for (int j = 0; j < CHIMA_AESNI_LANES; j += 2)
+                    _mm_storeu_si128((__m128i *)(aS + j),
+                                     CHIMA_AESNI_SBox(_mm_xor_si128(_mm_loadu_si128((const __m128i *)(aR + j)), key)));
+                for (int j = 0; j < CHIMA_AESNI_LANES; j++) {
+                    t = aR[j];
+                    aR[j] = aL[j] ^ CHIMA_BMI2_Permute(aS[j], K, 64);
+                    aL[j] = t;
+                }
+            }
+
+            for (int j = 0; j < CHIMA_AESNI_LANES; j++) {
+                half[decrypt]  = aL[j];
+                half[!decrypt] = aR[j];
+                words[0] = (uint32_t)(half[0] >> 32); words[1] = (uint32_t)half[0];
+                words[2] = (uint32_t)(half[1] >> 32); words[3] = (uint32_t)half[1];
+                BlockToBytes(words, out + j * bs, BLOCK_MODE_128);
+            }
+        }
+    }
+
+    return groups * CHIMA_AESNI_LANES;
+}
+
+/**
+ * @brief Cifra grupos de 4 blocos com AES-NI.
+ *
+ * @param pCtx Contexto
+ * @param in   Blocos claros
+ * @param out  Blocos cifrados
+ * @param n    Quantidade de blocos disponíveis
+ * @return Quantidade de blocos processados (múltiplo de 4)
+ */
+size_t CHIMA_AESNI_EncryptBlocks(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t n) {
+    return Feistel_Blocks_AESNI(pCtx, in, out, n, 0);
+}
+
+/**
+ * @brief Decifra grupos de 4 blocos com AES-NI.
+ *
+ * @param pCtx Contexto
+ * @param in   Blocos cifrados
+ * @param out  Blocos claros
+ * @param n    Quantidade de blocos disponíveis
+ * @return Quantidade de blocos processados (múltiplo de 4)
+ */
+size_t CHIMA_AESNI_DecryptBlocks(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t n) {
+    return Feistel_Blocks_AESNI(pCtx, in, out, n, 1);
+}
+
+/**
+ * @brief Inverte a ordem dos bits de cada via do registrador.
+ *
+ * @param x     Valor de entrada
+ * @param bswap Inversão da ordem dos bytes de cada via (define a largura)
+ * @return Valor com os bits invertidos
+ */
+static inline CHIMA_TARGET("ssse3") __m128i Reverse_Bits(__m128i x, __m128i bswap) {
+    const __m128i revLow  = _mm_setr_epi8(0x00, 0x80, 0x40, (char)0xC0, 0x20, (char)0xA0, 0x60, (char)0xE0,
+                                          0x10, (char)0x90, 0x50, (char)0xD0, 0x30, (char)0xB0, 0x70, (char)0xF0);
+    const __m128i revHigh = _mm_setr_epi8(0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE, 0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+
+    x = _mm_shuffle_epi8(x, bswap);
+    return _mm_or_si128(_mm_shuffle_epi8(revLow,  _mm_and_si128(x, nibble)),
+                        _mm_shuffle_epi8(revHigh, _mm_and_si128(_mm_srli_epi16(x, 4), nibble)));
+}
+
+/**
+ * @brief Cifra ou decifra grupos de 4 blocos, cada um com o seu contexto.
+ *
+ * Igual a Feistel_Blocks_AESNI, mas a chave somada antes da S-Box e a
+ * máscara do PDEP vêm do contexto de cada via. A inversão de bits da
+ * permutação é feita no registrador, para todas as vias de uma vez.
+ *
+ * @param apCtx   Contexto de cada bloco (mesmo xSize e ui32NumRounds)
+ * @param in      Blocos de entrada
+ * @param out     Blocos de saída
+ * @param n       Quantidade de blocos
+ * @param decrypt 0 para cifrar, 1 para decifrar
+ * @return Quantidade de blocos processados
+ */
+static CHIMA_TARGET("bmi2,aes,ssse3") size_t Feistel_MultiKey_AESNI(const CHIMA_Ctx *const *apCtx, const uint8_t *in, uint8_t *out, size_t n, int decrypt) {
+    BlockCipherSize xSize;
+    uint32_t bs, rounds, words[4], r;
+    size_t groups = n / CHIMA_AESNI_LANES;
+    const uint32_t *aRk[CHIMA_AESNI_LANES];
+
+    if (groups == 0)
+        return 0;
+    xSize = apCtx[0]->xSize;
+    bs = (xSize == BLOCK_MODE_64) ? 8 : 16;
+    rounds = apCtx[0]->ui32NumRounds;
+
+    for (size_t g = 0; g < groups; g++, apCtx += CHIMA_AESNI_LANES, in += CHIMA_AESNI_LANES * bs, out += CHIMA_AESNI_LANES * bs) {
+        for (int j = 0; j < CHIMA_AESNI_LANES; j++)
+            aRk[j] = apCtx[j]->aui32RoundKeys;
+
+        if (xSize == BLOCK_MODE_64) {
+            const __m128i bswap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+            uint32_t aL[CHIMA_AESNI_LANES], aR[CHIMA_AESNI_LANES], aS[CHIMA_AESNI_LANES], aV[CHIMA_AESNI_LANES], M, t;
+            __m128i v;
+
+            for (int j = 0; j < CHIMA_AESNI_LANES; j++) {
+                BlockFromBytes(in + j * bs, words, BLOCK_MODE_64);
+                aL[j] = decrypt ? words[1] : words[0];
+                aR[j] = decrypt ? words[0] : words[1];
+            }
+
+            for (uint32_t k = 0; k < rounds; k++) {
+                r = decrypt ? rounds - 1 - k : k;
+                v = _mm_xor_si128(_mm_loadu_si128((const __m128i *)aR),
+                                  _mm_setr_epi32((int)aRk[0][2 * r], (int)aRk[1][2 * r], (int)aRk[2][2 * r], (int)aRk[3][2 * r]));
+                v = CHIMA_AESNI_SBox(v);
+                _mm_storeu_si128((__m128i *)aS, v);
+                _mm_storeu_si128((__m128i *)aV, Reverse_Bits(v, bswap));
+                for (int j = 0; j < CHIMA_AESNI_LANES; j++) {
+                    M = aRk[j][2 * r + 1];
+                    t = aR[j];
+                    aR[j] = aL[j] ^ (uint32_t)(_pdep_u64(aS[j], ~M & 0xFFFFFFFFu) | _pdep_u64(aV[j], M));
+                    aL[j] = t;
+                }
+            }
+
+            for (int j = 0; j < CHIMA_AESNI_LANES; j++) {
+                words[0] = decrypt ? aR[j] : aL[j];
+                words[1] = decrypt ? aL[j] : aR[j];
+                BlockToBytes(words, out + j * bs, BLOCK_MODE_64);
+            }
+        } else {
+            const __m128i bswap = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+            uint64_t aL[CHIMA_AESNI_LANES], aR[CHIMA_AESNI_LANES], aS[CHIMA_AESNI_LANES], aV[CHIMA_AESNI_LANES], aK[CHIMA_AESNI_LANES];
+            uint64_t half[2], t;
+            __m128i v;
+
+            for (int j = 0; j < CHIMA_AESNI_LANES; j++) {
+                BlockFromBytes(in + j * bs, words, BLOCK_MODE_128);
+                half[0] = ((uint64_t)words[0] << 32) | words[1];
+                half[1] = ((uint64_t)words[2] << 32) | words[3];
+                aL[j] = half[decrypt];
+                aR[j] = half[!decrypt];
+            }
+
+            for (uint32_t k = 0; k < rounds; k++) {
+                r = decrypt ? rounds - 1 - k : k;
+                for (int j = 0; j < CHIMA_AESNI_LANES; j++)
+                    aK[j] = ((uint64_t)aRk[j][2 * r] << 32) | aRk[j][2 * r + 1];
+                for (int j = 0; j < CHIMA_AESNI_LANES; j += 2) {
+                    v = CHIMA_AESNI_SBox(_mm_xor_si128(_mm_loadu_si128((const __m128i *)(aR + j)),
+                                                       _mm_loadu_si128((const __m128i *)(aK + j))));
+                    _mm_storeu_si128((__m128i *)(aS + j), v);
+                    _mm_storeu_si128((__m128i *)(aV + j), Reverse_Bits(v, bswap));
+                }
+                for (int j = 0; j < CHIMA_AESNI_LANES; j++) {
+                    t = aR[j];
+                    aR[j] = aL[j] ^ _pdep_u64(aS[j], ~aK[j]) ^ _pdep_u64(aV[j], aK[j]);
+                    aL[j] = t;
+                }
+            }
+
+            for (int j = 0; j < CHIMA_AESNI_LANES; j++) {
+                half[decrypt]  = aL[j];
+                half[!decrypt] = aR[j];
+                words[0] = (uint32_t)(half[0] >> 32); words[1] = (uint32_t)half[0];
+                words[2] = (uint32_t)(half[1] >> 32); words[3] = (uint32_t)half[1];
+                BlockToBytes(words, out + j * bs, BLOCK_MODE_128);
+            }
+        }
+    }
+
+    return groups * CHIMA_AESNI_LANES;
+}
+
+/**
+ * @brief Cifra grupos de 4 blocos com um contexto por bloco.
+ *
+ * @param apCtx Contexto de cada bloco
+ * @param in    Blocos claros
+ * @param out   Blocos cifrados
+ * @param n     Quantidade de blocos disponíveis
+ * @return Quantidade de blocos processados (múltiplo de 4)
+ */
+size_t CHIMA_AESNI_EncryptMultiKey(const CHIMA_Ctx *const *apCtx, const uint8_t *in, uint8_t *out, size_t n) {
+    return Feistel_MultiKey_AESNI(apCtx, in, out, n, 0);
+}
+
+/**
+ * @brief Decifra grupos de 4 blocos com um contexto por bloco.
+ *
+ * @param apCtx Contexto de cada bloco
+ * @param in    Blocos cifrados
+ * @param out   Blocos claros
+ * @param n     Quantidade de blocos disponíveis
+ * @return Quantidade de blocos processados (múltiplo de 4)
+ */
+size_t CHIMA_AESNI_DecryptMultiKey(const CHIMA_Ctx *const *apCtx, const uint8_t *in, uint8_t *out, size_t n) {
+    return Feistel_MultiKey_AESNI(apCtx, in, out, n, 1);
+}
+
+#endif /* CHIMA_HAVE_AESNI */
@@ -0,0 +1,355 @@
+/**
+ * @file chima_avx2.c
+ * @author
+ * @brief Núcleo AVX2 da rede Feistel para vários blocos simultâneos.
+ * @version
+ * @date 2025-06-13
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * A S-Box é aplicada a 32 bytes por vez com a técnica de divisão em
+ * nibbles: o nibble baixo indexa, via vpshufb, cada uma das 16 linhas da
+ * S-Box do AES e o nibble alto seleciona a linha válida. A permutação de
+ * PermuteWithMask é constante em cada rodada, então vira duas expansões de
+ * bits (equivalentes a PDEP) com máscaras pré-calculadas, uma para os bits
+ * baixos e outra para os bits altos invertidos.
+ */
+
+
+// INCLUSÕES //
+
+#include "chima_kernels.h"
+#include "utils.h"
+
+#if defined(CHIMA_HAVE_AVX2)
+
+
+// DEFINIÇÕES //
+
+/** Passos da expansão de bits para metades de 32 bits */
+#define EXPAND_STEPS_32 5
+/** Passos da expansão de bits para metades de 64 bits */
+#define EXPAND_STEPS_64 6
+
+
+// TIPOS //
+
+/**
+ * @brief Máscaras da expansão de bits de uma rodada.
+ *
+ * aui64Zero leva os bits baixos às posições com bit 0 na máscara da
+ * rodada; aui64One leva os bits altos invertidos às posições com bit 1.
+ */
+typedef struct {
+    uint64_t aui64Zero[EXPAND_STEPS_64];
+    uint64_t aui64One [EXPAND_STEPS_64];
+    uint64_t ui64ZeroMask;
+    uint64_t ui64OneMask;
+    uint64_t ui64Key;
+} RoundMasks;
+
+/**
+ * @brief Constantes vetoriais usadas pelo núcleo.
+ */
+typedef struct {
+    __m256i aSBox[16]; /**< Linhas de 16 bytes da S-Box do AES */
+    __m256i revLow;    /**< Inversão de 4 bits, resultado no nibble alto */
+    __m256i revHigh;   /**< Inversão de 4 bits, resultado no nibble baixo */
+    __m256i bswap;     /**< Inversão da ordem dos bytes de cada via */
+} VectorTables;
+
+
+// FUNÇÕES //
+
+/**
+ * @brief Calcula as máscaras da expansão de bits (Hacker's Delight, 7-5).
+ *
+ * @param mask  Máscara de destino dos bits
+ * @param steps Número de passos (5 para 32 bits, 6 para 64 bits)
+ * @param mv    Máscaras de cada passo
+ */
+static void Expand_Masks(uint64_t mask, int steps, uint64_t *mv) {
+    uint64_t mk = ~mask << 1, mp;
+
+    for (int i = 0; i < steps; i++) {
+        mp = mk ^ (mk << 1);
+        mp ^= mp << 2;
+        mp ^= mp << 4;
+        mp ^= mp << 8;
+        mp ^= mp << 16;
+        mp ^= mp << 32;
+        mv[i] = mp & mask;
+        mask = (mask ^ mv[i]) | (mv[i] >> (1 << i));
+        mk &= ~mp;
+    }
+}
+
+/**
+ * @brief Prepara as máscaras de todas as rodadas do contexto.
+ *
+ * @param pCtx  Contexto com as chaves expandidas
+ * @param masks Vetor de saída (uma entrada por rodada)
+ */
+static void Prepare_Round_Masks(const CHIMA_Ctx *pCtx, RoundMasks *masks) {
+    const uint32_t *roundKeys = pCtx->aui32RoundKeys;
+    int steps = (pCtx->xSize == BLOCK_MODE_64) ? EXPAND_STEPS_32 : EXPAND_STEPS_64;
+    uint64_t valid = (pCtx->xSize == BLOCK_MODE_64) ? 0xFFFFFFFFULL : ~0ULL;
+    uint64_t mask;
+
+    for (uint32_t i = 0; i < pCtx->ui32NumRounds; i++) {
+        if (pCtx->xSize == BLOCK_MODE_64) {
+            masks[i].ui64Key = roundKeys[2 * i];
+            mask = roundKeys[2 * i + 1];
+        } else {
+            masks[i].ui64Key = ((uint64_t)roundKeys[2 * i] << 32) | roundKeys[2 * i + 1];
+            mask = masks[i].ui64Key;
+        }
+        masks[i].ui64ZeroMask = ~mask & valid;
+        masks[i].ui64OneMask  =  mask & valid;
+        Expand_Masks(masks[i].ui64ZeroMask, steps, masks[i].aui64Zero);
+        Expand_Masks(masks[i].ui64OneMask,  steps, masks[i].aui64One);
+    }
+}
+
+/**
+ * @brief Carrega as constantes vetoriais.
+ *
+ * @param pTables Estrutura de saída
+ * @param mode    Tamanho do bloco (define a largura das vias)
+ */
+static CHIMA_TARGET("avx2") void Load_Tables(VectorTables *pTables, BlockCipherSize mode) {
+    static const uint8_t aucRev4[16] = {
+        0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE,
+        0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF
+    };
+    uint8_t aucLow[16], aucHigh[16], aucSwap[16];
+
+    for (int h = 0; h < 16; h++)
+        pTables->aSBox[h] = _mm256_broadcastsi128_si256(
+            _mm_loadu_si128((const __m128i *)(g_AesSBox + 16 * h)));
+
+    for (int v = 0; v < 16; v++) {
+        aucLow[v]  = (uint8_t)(aucRev4[v] << 4);
+        aucHigh[v] = aucRev4[v];
+        aucSwap[v] = (mode == BLOCK_MODE_64) ? (uint8_t)((v & ~3) + 3 - (v & 3))
+                                             : (uint8_t)((v & ~7) + 7 - (v & 7));
+    }
+    pTables->revLow  = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)aucLow));
+    pTables->revHigh = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)aucHigh));
+    pTables->bswap   = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)aucSwap));
+}
+
+/**
+ * @brief Aplica a S-Box do AES a cada um dos 32 bytes.
+ *
+ * Subtrair 16*h zera o nibble alto só dos bytes da linha h; a soma
+ * saturada com 0x70 liga o bit 7 dos demais, que o vpshufb zera.
+ *
+ * @param x       Bytes de entrada
+ * @param pTables Constantes vetoriais
+ * @return Bytes substituídos
+ */
+static inline CHIMA_TARGET("avx2") __m256i SBox_AVX2(__m256i x, const VectorTables *pTables) {
+    const __m256i bias = _mm256_set1_epi8(0x70);
+    const __m256i step = _mm256_set1_epi8(0x10);
+    __m256i result = _mm256_setzero_si256();
+
+    for (int h = 0; h < 16; h++) {
+        result = _mm256_or_si256(result,
+                 _mm256_shuffle_epi8(pTables->aSBox[h], _mm256_adds_epu8(x, bias)));
+        x = _mm256_sub_epi8(x, step);
+    }
+    return result;
+}
+
+/**
+ * @brief Inverte a ordem dos bits de cada via.
+ *
+ * @param x       Valor de entrada
+ * @param pTables Constantes vetoriais (bswap define a largura da via)
+ * @return Valor com os bits invertidos
+ */
+static inline CHIMA_TARGET("avx2") __m256i Reverse_AVX2(__m256i x, const VectorTables *pTables) {
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+
+    x = _mm256_shuffle_epi8(x, pTables->bswap);
+    return _mm256_or_si256(
+        _mm256_shuffle_epi8(pTables->revLow,  _mm256_and_si256(x, nibble)),
+        _mm256_shuffle_epi8(pTables->revHigh, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble)));
+}
+
+/**
+ * @brief Um passo da expansão: move para cima os bits selecionados por mv.
+ */
+static inline CHIMA_TARGET("avx2") __m256i Expand_Step(__m256i x, __m256i shifted, __m256i mv) {
+    return _mm256_xor_si256(x, _mm256_and_si256(_mm256_xor_si256(x, shifted), mv));
+}
+
+/**
+ * @brief Expansão de bits (PDEP com máscara constante) em vias de 32 bits.
+ */
+static inline CHIMA_TARGET("avx2") __m256i Expand32_AVX2(__m256i x, const uint64_t *mv, uint64_t mask) {
+    x = Expand_Step(x, _mm256_slli_epi32(x, 16), _mm256_set1_epi32((int32_t)mv[4]));
+    x = Expand_Step(x, _mm256_slli_epi32(x, 8),  _mm256_set1_epi32((int32_t)mv[3]));
+    x = Expand_Step(x, _mm256_slli_epi32(x, 4),  _mm256_set1_epi32((int32_t)mv[2]));
+    x = Expand_Step(x, _mm256_slli_epi32(x, 2),  _mm256_set1_epi32((int32_t)mv[1]));
+    x = Expand_Step(x, _mm256_slli_epi32(x, 1),  _mm256_set1_epi32((int32_t)mv[0]));
+    return _mm256_and_si256(x, _mm256_set1_epi32((int32_t)mask));
+}
+
+/**
+ * @brief Expansão de bits (PDEP com máscara constante) em vias de 64 bits.
+ */
+static inline CHIMA_TARGET("avx2") __m256i Expand64_AVX2(__m256i x, const uint64_t *mv, uint64_t mask) {
+    x = Expand_Step(x, _mm256_slli_epi64(x, 32), _mm256_set1_epi64x((int64_t)mv[5]));
+    x = Expand_Step(x, _mm256_slli_epi64(x, 16), _mm256_set1_epi64x((int64_t)mv[4]));
+    x = Expand_Step(x, _mm256_slli_epi64(x, 8),  _mm256_set1_epi64x((int64_t)mv[3]));
+    x = Expand_Step(x, _mm256_slli_epi64(x, 4),  _mm256_set1_epi64x((int64_t)mv[2]));
+    x = Expand_Step(x, _mm256_slli_epi64(x, 2),  _mm256_set1_epi64x((int64_t)mv[1]));
+    x = Expand_Step(x, _mm256_slli_epi64(x, 1),  _mm256_set1_epi64x((int64_t)mv[0]));
+    return _mm256_and_si256(x, _mm256_set1_epi64x((int64_t)mask));
+}
+
+/**
+ * @brief Função de rodada para metades de 32 bits (BLOCK_MODE_64).
+ */
+static inline CHIMA_TARGET("avx2") __m256i Round32_AVX2(__m256i r, const RoundMasks *pMasks, const VectorTables *pTables) {
+    __m256i s = SBox_AVX2(_mm256_xor_si256(r, _mm256_set1_epi32((int32_t)pMasks->ui64Key)), pTables);
+    return _mm256_or_si256(Expand32_AVX2(s, pMasks->aui64Zero, pMasks->ui64ZeroMask),
+                           Expand32_AVX2(Reverse_AVX2(s, pTables), pMasks->aui64One, pMasks->ui64OneMask));
+}
+
+/**
+ * @brief Função de rodada para metades de 64 bits (BLOCK_MODE_128).
+ */
+static inline CHIMA_TARGET("avx2") __m256i Round64_AVX2(__m256i r, const RoundMasks *pMasks, const VectorTables *pTables) {
+    __m256i s = SBox_AVX2(_mm256_xor_si256(r, _mm256_set1_epi64x((int64_t)pMasks->ui64Key)), pTables);
+    return _mm256_or_si256(Expand64_AVX2(s, pMasks->aui64Zero, pMasks->ui64ZeroMask),
+                           Expand64_AVX2(Reverse_AVX2(s, pTables), pMasks->aui64One, pMasks->ui64OneMask));
+}
+
+/**
+ * @brief Processa grupos de 8 blocos pela rede Feistel.
+ *
+ * A decifração é a mesma rodada com as metades trocadas e as chaves em
+ * ordem inversa.
+ *
+ * @param pCtx    Contexto
+ * @param in      Blocos de entrada
+ * @param out     Blocos de saída
+ * @param n       Quantidade de blocos
+ * @param decrypt 0 para cifrar, 1 para decifrar
+ * @return Quantidade de blocos processados
+ */
+static CHIMA_TARGET("avx2") size_t Feistel_Blocks_AVX2(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t n, int decrypt) {
+    uint32_t bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    size_t groups = n / CHIMA_AVX2_LANES;
+    uint32_t rounds = pCtx->ui32NumRounds, words[4];
+    RoundMasks masks[CHIMA_MAX_ROUNDS];
+    VectorTables tables;
+    const RoundMasks *pRound;
+
+    if (groups == 0)
+        return 0;
+
+    Prepare_Round_Masks(pCtx, masks);
+    Load_Tables(&tables, pCtx->xSize);
+
+    for (size_t g = 0; g < groups; g++, in += CHIMA_AVX2_LANES * bs, out += CHIMA_AVX2_LANES * bs) {
+        if (pCtx->xSize == BLOCK_MODE_64) {
+            uint32_t aL[CHIMA_AVX2_LANES], aR[CHIMA_AVX2_LANES];
+            __m256i a, b, t;
+
+            for (int j = 0; j < CHIMA_AVX2_LANES; j++) {
+                BlockFromBytes(in + j * bs, words, BLOCK_MODE_64);
+                aL[j] = decrypt ? words[1] : words[0];
+                aR[j] = decrypt ? words[0] : words[1];
+            }
+            a = _mm256_loadu_si256((const __m256i *)aL);
+            b = _mm256_loadu_si256((const __m256i *)aR);
+
+            for (uint32_t k = 0; k < rounds; k++) {
+                pRound = &masks[decrypt ? rounds - 1 - k : k];
+                t = b;
+                b = _mm256_xor_si256(a, Round32_AVX2(b, pRound, &tables));
+                a = t;
+            }
+
+            _mm256_storeu_si256((__m256i *)aL, a);
+            _mm256_storeu_si256((__m256i *)aR, b);
+            for (int j = 0; j < CHIMA_AVX2_LANES; j++) {
+                words[0] = decrypt ? aR[j] : aL[j];
+                words[1] = decrypt ? aL[j] : aR[j];
+                BlockToBytes(words, out + j * bs, BLOCK_MODE_64);
+            }
+        } else {
+            uint64_t aL[CHIMA_AVX2_LANES], aR[CHIMA_AVX2_LANES], half[2];
+            __m256i a0, a1, b0, b1, t0, t1;
+
+            for (int j = 0; j < CHIMA_AVX2_LANES; j++) {
+                BlockFromBytes(in + j * bs, words, BLOCK_MODE_128);
+                half[0] = ((uint64_t)words[0] << 32) | words[1];
+                half[1] = ((uint64_t)words[2] << 32) | words[3];
+                aL[j] = half[decrypt];
+                aR[j] = half[!decrypt];
+            }
+            a0 = _mm256_loadu_si256((const __m256i *)aL);
+            a1 = _mm256_loadu_si256((const __m256i *)(aL + 4));
+            b0 = _mm256_loadu_si256((const __m256i *)aR);
+            b1 = _mm256_loadu_si256((const __m256i *)(aR + 4));
+
+            for (uint32_t k = 0; k < rounds; k++) {
+                pRound = &masks[decrypt ? rounds - 1 - k : k];
+                t0 = b0;
+                t1 = b1;
+                b0 = _mm256_xor_si256(a0, Round64_AVX2(b0, pRound, &tables));
+                b1 = _mm256_xor_si256(a1, Round64_AVX2(b1, pRound, &tables));
+                a0 = t0;
+                a1 = t1;
+            }
+
+            _mm256_storeu_si256((__m256i *)aL, a0);
+            _mm256_storeu_si256((__m256i *)(aL + 4), a1);
+            _mm256_storeu_si256((__m256i *)aR, b0);
+            _mm256_storeu_si256((__m256i *)(aR + 4), b1);
+            for (int j = 0; j < CHIMA_AVX2_LANES; j++) {
+                half[decrypt]  = aL[j];
+                half[!decrypt] = aR[j];
+                words[0] = (uint32_t)(half[0] >> 32); words[1] = (uint32_t)half[0];
+                words[2] = (uint32_t)(half[1] >> 32); words[3] = (uint32_t)half[1];
+                BlockToBytes(words, out + j * bs, BLOCK_MODE_128);
+            }
+        }
+    }
+
+    SecureZero(masks, rounds * sizeof(RoundMasks));
+    return groups * CHIMA_AVX2_LANES;
+}
+
+/**
+ * @brief Cifra grupos de 8 blocos com AVX2.
+ *
+ * @param pCtx Contexto
+ * @param in   Blocos claros
+ * @param out  Blocos cifrados
+ * @param n    Quantidade de blocos disponíveis
+ * @return Quantidade de blocos processados (múltiplo de 8)
+ */
+size_t CHIMA_AVX2_EncryptBlocks(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t n) {
+    return Feistel_Blocks_AVX2(pCtx, in, out, n, 0);
+}
+
+/**
+ * @brief Decifra grupos de 8 blocos com AVX2.
+ *
+ * @param pCtx Contexto
+ * @param in   Blocos cifrados
+ * @param out  Blocos claros
+ * @param n    Quantidade de blocos disponíveis
+ * @return Quantidade de blocos processados (múltiplo de 8)
+ */
+size_t CHIMA_AVX2_DecryptBlocks(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t n) {
+    return Feistel_Blocks_AVX2(pCtx, in, out, n, 1);
+}
+
+#endif /* CHIMA_HAVE_AVX2 */
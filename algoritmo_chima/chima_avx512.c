@@ -0,0 +1,267 @@
+/**
+ * @file chima_avx512.c
+ * @author
+ * @brief Núcleo AVX-512 (GFNI/VBMI) da rede Feistel sem consultas a tabelas.
+ * @version
+ * @date 2025-06-13
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Os blocos são mantidos transpostos por byte: cada qword (modo de 128
+ * bits) ou cada via de 128 bits (modo de 64 bits) guarda o mesmo byte da
+ * metade direita de todos os blocos. Assim a S-Box é um único
+ * GF2P8AFFINEINVQB e a permutação de bits da rodada vira, para cada byte
+ * de origem, uma difusão desse byte para todas as posições seguida de um
+ * GF2P8AFFINEQB com uma matriz 8x8 por byte de destino. Nenhum acesso à
+ * memória depende dos dados ou da chave.
+ */
+
+
+// INCLUSÕES //
+
+#include "chima_kernels.h"
+#include "utils.h"
+
+#if defined(CHIMA_HAVE_AVX512)
+
+
+// DEFINIÇÕES //
+
+/** Matriz afim da S-Box do AES para GF2P8AFFINEINVQB */
+#define AES_AFFINE_MATRIX 0xF1E3C78F1F3E7CF8ULL
+/** Constante afim da S-Box do AES */
+#define AES_AFFINE_CONST  0x63
+/** Extensões usadas pelas funções vetoriais deste arquivo */
+#define AVX512_TARGET     CHIMA_TARGET("avx512f,avx512bw,avx512vbmi,gfni")
+
+
+// TIPOS //
+
+/**
+ * @brief Constantes de uma rodada no leiaute transposto.
+ */
+typedef struct {
+    __m512i key;     /**< Chave da rodada difundida por byte */
+    __m512i mat[8];  /**< Matrizes por byte de origem (uma por byte de destino) */
+} RoundConsts;
+
+
+// FUNÇÕES //
+
+/**
+ * @brief Monta as matrizes 8x8 da permutação de uma rodada.
+ *
+ * Percorre PermuteWithMask uma vez: o bit de saída k vem do bit src de
+ * entrada, então a matriz (byte src/8 -> byte k/8) ganha, na linha 7-(k%8)
+ * (convenção de GF2P8AFFINEQB), o bit src%8.
+ *
+ * @param mask      Máscara de permutação
+ * @param num_bytes Bytes da metade do bloco
+ * @param matrix    Saída: matrix[origem][destino]
+ */
+static void Permutation_Matrices(uint64_t mask, int num_bytes, uint64_t matrix[8][8]) {
+    int i = 0, j = num_bytes * 8 - 1, src;
+
+    memset(matrix, 0, 8 * 8 * sizeof(uint64_t));
+    for (int k = 0; k < num_bytes * 8; k++) {
+        src = ((mask >> k) & 1) ? j-- : i++;
+        matrix[src >> 3][k >> 3] |= (uint64_t)(1u << (src & 7)) << (8 * (7 - (k & 7)));
+    }
+}
+
+/**
+ * @brief Prepara as constantes de todas as rodadas.
+ *
+ * @param pCtx    Contexto com as chaves expandidas
+ * @param pConsts Vetor de saída (uma entrada por rodada)
+ */
+static AVX512_TARGET void Prepare_Round_Consts(const CHIMA_Ctx *pCtx, RoundConsts *pConsts) {
+    const uint32_t *roundKeys = pCtx->aui32RoundKeys;
+    int num_bytes = (pCtx->xSize == BLOCK_MODE_64) ? 4 : 8;
+    int width = 64 / num_bytes;  // bytes do leiaute por byte da metade
+    uint64_t key, mask, matrix[8][8], lanes[8];
+    uint8_t bytes[64];
+
+    for (uint32_t r = 0; r < pCtx->ui32NumRounds; r++) {
+        if (pCtx->xSize == BLOCK_MODE_64) {
+            key  = roundKeys[2 * r];
+            mask = roundKeys[2 * r + 1];
+        } else {
+            key  = ((uint64_t)roundKeys[2 * r] << 32) | roundKeys[2 * r + 1];
+            mask = key;
+        }
+
+        for (int b = 0; b < 64; b++)
+            bytes[b] = (uint8_t)(key >> (8 * (b / width)));
+        pConsts[r].key = _mm512_loadu_si512(bytes);
+
+        Permutation_Matrices(mask, num_bytes, matrix);
+        for (int from = 0; from < num_bytes; from++) {
+            for (int q = 0; q < 8; q++)
+                lanes[q] = matrix[from][q * 8 / width];
+            pConsts[r].mat[from] = _mm512_loadu_si512(lanes);
+        }
+    }
+}
+
+/**
+ * @brief Função de rodada para 8 metades de 64 bits transpostas.
+ */
+static inline AVX512_TARGET __m512i Round64_AVX512(__m512i r, const RoundConsts *pRound) {
+    __m512i s = _mm512_gf2p8affineinv_epi64_epi8(_mm512_xor_si512(r, pRound->key),
+                    _mm512_set1_epi64((int64_t)AES_AFFINE_MATRIX), AES_AFFINE_CONST);
+    __m512i p = _mm512_setzero_si512();
+
+    for (int from = 0; from < 8; from++)
+        p = _mm512_xor_si512(p, _mm512_gf2p8affine_epi64_epi8(
+                _mm512_permutexvar_epi64(_mm512_set1_epi64(from), s), pRound->mat[from], 0));
+    return p;
+}
+
+/**
+ * @brief Função de rodada para 16 metades de 32 bits transpostas.
+ */
+static inline AVX512_TARGET __m512i Round32_AVX512(__m512i r, const RoundConsts *pRound) {
+    __m512i s = _mm512_gf2p8affineinv_epi64_epi8(_mm512_xor_si512(r, pRound->key),
+                    _mm512_set1_epi64((int64_t)AES_AFFINE_MATRIX), AES_AFFINE_CONST);
+    __m512i p;
+
+    p =                     _mm512_gf2p8affine_epi64_epi8(_mm512_shuffle_i64x2(s, s, 0x00), pRound->mat[0], 0);
+    p = _mm512_xor_si512(p, _mm512_gf2p8affine_epi64_epi8(_mm512_shuffle_i64x2(s, s, 0x55), pRound->mat[1], 0));
+    p = _mm512_xor_si512(p, _mm512_gf2p8affine_epi64_epi8(_mm512_shuffle_i64x2(s, s, 0xAA), pRound->mat[2], 0));
+    p = _mm512_xor_si512(p, _mm512_gf2p8affine_epi64_epi8(_mm512_shuffle_i64x2(s, s, 0xFF), pRound->mat[3], 0));
+    return p;
+}
+
+/**
+ * @brief Processa grupos de 16 blocos pela rede Feistel.
+ *
+ * @param pCtx    Contexto
+ * @param in      Blocos de entrada
+ * @param out     Blocos de saída
+ * @param n       Quantidade de blocos
+ * @param decrypt 0 para cifrar, 1 para decifrar
+ * @return Quantidade de blocos processados
+ */
+static AVX512_TARGET size_t Feistel_Blocks_AVX512(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t n, int decrypt) {
+    uint32_t bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    size_t groups = n / CHIMA_AVX512_LANES;
+    uint32_t rounds = pCtx->ui32NumRounds, words[4];
+    RoundConsts consts[CHIMA_MAX_ROUNDS];
+    const RoundConsts *pRound;
+    uint8_t fwd[64], inv[64];
+    __m512i toT, fromT;
+
+    if (groups == 0)
+        return 0;
+
+    Prepare_Round_Consts(pCtx, consts);
+    for (int b = 0; b < 64; b++) {
+        if (pCtx->xSize == BLOCK_MODE_64) {
+            fwd[b] = (uint8_t)(4 * (b % 16) + b / 16);
+            inv[b] = (uint8_t)(16 * (b % 4) + b / 4);
+        } else {
+            fwd[b] = inv[b] = (uint8_t)(8 * (b % 8) + b / 8);
+        }
+    }
+    toT   = _mm512_loadu_si512(fwd);
+    fromT = _mm512_loadu_si512(inv);
+
+    for (size_t g = 0; g < groups; g++, in += CHIMA_AVX512_LANES * bs, out += CHIMA_AVX512_LANES * bs) {
+        if (pCtx->xSize == BLOCK_MODE_64) {
+            uint32_t aL[CHIMA_AVX512_LANES], aR[CHIMA_AVX512_LANES];
+            __m512i a, b, t;
+
+            for (int j = 0; j < CHIMA_AVX512_LANES; j++) {
+                BlockFromBytes(in + j * bs, words, BLOCK_MODE_64);
+                aL[j] = words[decrypt];
+                aR[j] = words[!decrypt];
+            }
+            a = _mm512_permutexvar_epi8(toT, _mm512_loadu_si512(aL));
+            b = _mm512_permutexvar_epi8(toT, _mm512_loadu_si512(aR));
+
+            for (uint32_t k = 0; k < rounds; k++) {
+                pRound = &consts[decrypt ? rounds - 1 - k : k];
+                t = b;
+                b = _mm512_xor_si512(a, Round32_AVX512(b, pRound));
+                a = t;
+            }
+
+            _mm512_storeu_si512(aL, _mm512_permutexvar_epi8(fromT, a));
+            _mm512_storeu_si512(aR, _mm512_permutexvar_epi8(fromT, b));
+            for (int j = 0; j < CHIMA_AVX512_LANES; j++) {
+                words[decrypt]  = aL[j];
+                words[!decrypt] = aR[j];
+                BlockToBytes(words, out + j * bs, BLOCK_MODE_64);
+            }
+        } else {
+            uint64_t aL[CHIMA_AVX512_LANES], aR[CHIMA_AVX512_LANES], half[2];
+            __m512i a0, a1, b0, b1, t0, t1;
+
+            for (int j = 0; j < CHIMA_AVX512_LANES; j++) {
+                BlockFromBytes(in + j * bs, words, BLOCK_MODE_128);
+                half[0] = ((uint64_t)words[0] << 32) | words[1];
+                half[1] = ((uint64_t)words[2] << 32) | words[3];
+                aL[j] = half[decrypt];
+                aR[j] = half[!decrypt];
+            }
+            a0 = _mm512_permutexvar_epi8(toT, _mm512_loadu_si512(aL));
+            a1 = _mm512_permutexvar_epi8(toT, _mm512_loadu_si512(aL + 8));
+            b0 = _mm512_permutexvar_epi8(toT, _mm512_loadu_si512(aR));
+            b1 = _mm512_permutexvar_epi8(toT, _mm512_loadu_si512(aR + 8));
+
+            for (uint32_t k = 0; k < rounds; k++) {
+                pRound = &consts[decrypt ? rounds - 1 - k : k];
+                t0 = b0;
+                t1 = b1;
+                b0 = _mm512_xor_si512(a0, Round64_AVX512(b0, pRound));
+                b1 = _mm512_xor_si512(a1, Round64_AVX512(b1, pRound));
+                a0 = t0;
+                a1 = t1;
+            }
+
+            _mm512_storeu_si512(aL,     _mm512_permutexvar_epi8(fromT, a0));
+            _mm512_storeu_si512(aL + 8, _mm512_permutexvar_epi8(fromT, a1));
+            _mm512_storeu_si512(aR,     _mm512_permutexvar_epi8(fromT, b0));
+            _mm512_storeu_si512(aR + 8, _mm512_permutexvar_epi8(fromT, b1));
+            for (int j = 0; j < CHIMA_AVX512_LANES; j++) {
+                half[decrypt]  = aL[j];
+                half[!decrypt] = aR[j];
+                words[0] = (uint32_t)(half[0] >> 32); words[1] = (uint32_t)half[0];
+                words[2] = (uint32_t)(half[1] >> 32); words[3] = (uint32_t)half[1];
+                BlockToBytes(words, out + j * bs, BLOCK_MODE_128);
+            }
+        }
+    }
+
+    SecureZero(consts, pCtx->ui32NumRounds * sizeof(RoundConsts));
+    return groups * CHIMA_AVX512_LANES;
+}
+
+/**
+ * @brief Cifra grupos de 16 blocos com AVX-512/GFNI.
+ *
+ * @param pCtx Contexto
+ * @param in   Blocos claros
+ * @param out  Blocos cifrados
+ * @param n    Quantidade de blocos disponíveis
+ * @return Quantidade de blocos processados (múltiplo de 16)
+ */
+size_t CHIMA_AVX512_EncryptBlocks(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t n) {
+    return Feistel_Blocks_AVX512(pCtx, in, out, n, 0);
+}
+
+/**
+ * @brief Decifra grupos de 16 blocos com AVX-512/GFNI.
+ *
+ * @param pCtx Contexto
+ * @param in   Blocos cifrados
+ * @param out  Blocos claros
+ * @param n    Quantidade de blocos disponíveis
+ * @return Quantidade de blocos processados (múltiplo de 16)
+ */
+size_t CHIMA_AVX512_DecryptBlocks(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t n) {
+    return Feistel_Blocks_AVX512(pCtx, in, out, n, 1);
+}
+
+#endif /* CHIMA_HAVE_AVX512 */
@@ -0,0 +1,413 @@
+/**
+ * @file chima_bitslice.c
+ * @author
+ * @brief Núcleo bitsliced da rede Feistel para 64 ou 128 blocos por vez.
+ * @version
+ * @date 2025-06-13
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Os blocos são transpostos em planos de bits: o plano i guarda o bit i
+ * da metade de cada bloco, um bloco por bit da palavra. A S-Box do AES
+ * vira o circuito booleano de Boyar-Peralta (apenas AND/XOR/XNOR) e a
+ * permutação de PermuteWithMask, fixa em cada rodada, é só a escolha de
+ * qual plano é somado a qual, calculada uma vez por chamada. Não há
+ * acessos à memória dependentes dos dados.
+ */
+
+
+// INCLUSÕES //
+
+#include "chima_kernels.h"
+#include "utils.h"
+
+
+// DEFINIÇÕES //
+
+/** Palavras de 64 bits em cada plano */
+#define BITSLICE_WORDS (CHIMA_BITSLICE_LANES / 64)
+
+
+// TIPOS //
+
+#if BITSLICE_WORDS > 1
+/** Plano de bits: um bit por bloco */
+typedef uint64_t BitSlice __attribute__((vector_size(8 * BITSLICE_WORDS)));
+#else
+/** Plano de bits: um bit por bloco */
+typedef uint64_t BitSlice;
+#endif
+
+
+// FUNÇÕES //
+
+/**
+ * @brief Transpõe uma matriz de 64x64 bits.
+ *
+ * Após a chamada, o bit j de a[i] é o bit i da linha a[j] original.
+ *
+ * @param a Linhas da matriz (entrada/saída)
+ */
+static void Transpose64(uint64_t *a) {
+    uint64_t m = 0x00000000FFFFFFFFULL, t;
+
+    for (int j = 32; j != 0; j >>= 1, m ^= m << j) {
+        for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+            t = ((a[k] >> j) ^ a[k | j]) & m;
+            a[k] ^= t << j;
+            a[k | j] ^= t;
+        }
+    }
+}
+
+/**
+ * @brief Calcula de qual bit vem cada posição da saída de PermuteWithMask.
+ *
+ * @param mask     Máscara de permutação
+ * @param num_bits Número de bits válidos
+ * @param src      Vetor de saída: src[p] é o bit de origem da posição p
+ */
+static void Permutation_Sources(uint64_t mask, int num_bits, uint8_t *src) {
+    int low = 0, high = num_bits - 1;
+
+    for (int p = 0; p < num_bits; p++)
+        src[p] = (uint8_t)(((mask >> p) & 1) ? high-- : low++);
+}
+
+/**
+ * @brief Preenche todas as palavras de um plano com o mesmo valor.
+ *
+ * @param v Valor de cada palavra
+ * @return Plano preenchido
+ */
+static inline BitSlice Slice_Fill(uint64_t v) {
+    uint64_t w[BITSLICE_WORDS];
+    BitSlice s;
+
+    for (int i = 0; i < BITSLICE_WORDS; i++)
+        w[i] = v;
+    memcpy(&s, w, sizeof(s));
+    return s;
+}
+
+/**
+ * @brief S-Box do AES em forma de circuito (Boyar-Peralta, 113 portas).
+ *
+ * @param q Planos dos bits 0 a 7 de um byte (entrada/saída)
+ */
+static void SBox_Bitslice(BitSlice *q) {
+    BitSlice x0, x1, x2, x3, x4, x5, x6, x7;
+    BitSlice y1, y2, y3, y4, y5, y6, y7, y8, y9, y10, y11, y12, y13, y14, y15, y16, y17, y18, y19, y20, y21;
+    BitSlice z0, z1, z2, z3, z4, z5, z6, z7, z8, z9, z10, z11, z12, z13, z14, z15, z16, z17;
+    BitSlice t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13, t14, t15, t16, t17, t18, t19;
+    BitSlice t20, t21, t22, t23, t24, t25, t26, t27, t28, t29, t30, t31, t32, t33, t34, t35, t36, t37, t38, t39;
+    BitSlice t40, t41, t42, t43, t44, t45, t46, t47, t48, t49, t50, t51, t52, t53, t54, t55, t56, t57, t58, t59;
+    BitSlice t60, t61, t62, t63, t64, t65, t66, t67;
+    BitSlice s0, s1, s2, s3, s4, s5, s6, s7;
+
+    x0 = q[7]; x1 = q[6]; x2 = q[5]; x3 = q[4];
+    x4 = q[3]; x5 = q[2]; x6 = q[1]; x7 = q[0];
+
+    // Transformação linear de entrada
+    y14 = x3 ^ x5;
+    y13 = x0 ^ x6;
+    y9 = x0 ^ x3;
+    y8 = x0 ^ x5;
+    t0 = x1 ^ x2;
+    y1 = t0 ^ x7;
+    y4 = y1 ^ x3;
+    y12 = y13 ^ y14;
+    y2 = y1 ^ x0;
+    y5 = y1 ^ x6;
+    y3 = y5 ^ y8;
+    t1 = x4 ^ y12;
+    y15 = t1 ^ x5;
+    y20 = t1 ^ x1;
+    y6 = y15 ^ x7;
+    y10 = y15 ^ t0;
+    y11 = y20 ^ y9;
+    y7 = x7 ^ y11;
+    y17 = y10 ^ y11;
+    y19 = y10 ^ y8;
+    y16 = t0 ^ y11;
+    y21 = y13 ^ y16;
+    y18 = x0 ^ y16;
+
+    // Parte não linear (inversão em GF(2^8))
+    t2 = y12 & y15;
+    t3 = y3 & y6;
+    t4 = t3 ^ t2;
+    t5 = y4 & x7;
+    t6 = t5 ^ t2;
+    t7 = y13 & y16;
+    t8 = y5 & y1;
+    t9 = t8 ^ t7;
+    t10 = y2 & y7;
+    t11 = t10 ^ t7;
+    t12 = y9 & y11;
+    t13 = y14 & y17;
+    t14 = t13 ^ t12;
+    t15 = y8 & y10;
+    t16 = t15 ^ t12;
+    t17 = t4 ^ t14;
+    t18 = t6 ^ t16;
+    t19 = t9 ^ t14;
+    t20 = t11 ^ t16;
+    t21 = t17 ^ y20;
+    t22 = t18 ^ y19;
+    t23 = t19 ^ y21;
+    t24 = t20 ^ y18;
+
+    t25 = t21 ^ t22;
+    t26 = t21 & t23;
+    t27 = t24 ^ t26;
+    t28 = t25 & t27;
+    t29 = t28 ^ t22;
+    t30 = t23 ^ t24;
+    t31 = t22 ^ t26;
+    t32 = t31 & t30;
+    t33 = t32 ^ t24;
+    t34 = t23 ^ t33;
+    t35 = t27 ^ t33;
+    t36 = t24 & t35;
+    t37 = t36 ^ t34;
+    t38 = t27 ^ t36;
+    t39 = t29 & t38;
+    t40 = t25 ^ t39;
+
+    t41 = t40 ^ t37;
+    t42 = t29 ^ t33;
+    t43 = t29 ^ t40;
+    t44 = t33 ^ t37;
+    t45 = t42 ^ t41;
+    z0 = t44 & y15;
+    z1 = t37 & y6;
+    z2 = t33 & x7;
+    z3 = t43 & y16;
+    z4 = t40 & y1;
+    z5 = t29 & y7;
+    z6 = t42 & y11;
+    z7 = t45 & y17;
+    z8 = t41 & y10;
+    z9 = t44 & y12;
+    z10 = t37 & y3;
+    z11 = t33 & y4;
+    z12 = t43 & y13;
+    z13 = t40 & y5;
+    z14 = t29 & y2;
+    z15 = t42 & y9;
+    z16 = t45 & y14;
+    z17 = t41 & y8;
+
+    // Transformação linear de saída
+    t46 = z15 ^ z16;
+    t47 = z10 ^ z11;
+    t48 = z5 ^ z13;
+    t49 = z9 ^ z10;
+    t50 = z2 ^ z12;
+    t51 = z2 ^ z5;
+    t52 = z7 ^ z8;
+    t53 = z0 ^ z3;
+    t54 = z6 ^ z7;
+    t55 = z16 ^ z17;
+    t56 = z12 ^ t48;
+    t57 = t50 ^ t53;
+    t58 = z4 ^ t46;
+    t59 = z3 ^ t54;
+    t60 = t46 ^ t57;
+    t61 = z14 ^ t57;
+    t62 = t52 ^ t58;
+    t63 = t49 ^ t58;
+    t64 = z4 ^ t59;
+    t65 = t61 ^ t62;
+    t66 = z1 ^ t63;
+    s0 = t59 ^ t63;
+    s6 = t56 ^ ~t62;
+    s7 = t48 ^ ~t60;
+    t67 = t64 ^ t65;
+    s3 = t53 ^ t66;
+    s4 = t51 ^ t66;
+    s5 = t47 ^ t65;
+    s1 = t64 ^ ~s3;
+    s2 = t55 ^ ~t67;
+
+    q[7] = s0; q[6] = s1; q[5] = s2; q[4] = s3;
+    q[3] = s4; q[2] = s5; q[1] = s6; q[0] = s7;
+}
+
+/**
+ * @brief Transpõe metades de blocos em planos de bits.
+ *
+ * @param halves Metades, uma por bloco (CHIMA_BITSLICE_LANES valores)
+ * @param planes Planos de saída (64 planos)
+ */
+static void Slices_From_Halves(uint64_t *halves, BitSlice *planes) {
+    uint64_t w[64][BITSLICE_WORDS];
+
+    for (int g = 0; g < BITSLICE_WORDS; g++) {
+        Transpose64(halves + 64 * g);
+        for (int i = 0; i < 64; i++)
+            w[i][g] = halves[64 * g + i];
+    }
+    memcpy(planes, w, sizeof(w));
+}
+
+/**
+ * @brief Operação inversa de Slices_From_Halves.
+ *
+ * @param planes Planos de bits (64 planos)
+ * @param halves Metades de saída, uma por bloco
+ */
+static void Halves_From_Slices(const BitSlice *planes, uint64_t *halves) {
+    uint64_t w[64][BITSLICE_WORDS];
+
+    memcpy(w, planes, sizeof(w));
+    for (int g = 0; g < BITSLICE_WORDS; g++) {
+        for (int i = 0; i < 64; i++)
+            halves[64 * g + i] = w[i][g];
+        Transpose64(halves + 64 * g);
+    }
+}
+
+/**
+ * @brief Executa as rodadas sobre as metades em planos de bits.
+ *
+ * @param a        Planos da metade esquerda
+ * @param b        Planos da metade direita
+ * @param num_bits Bits por metade (32 ou 64)
+ * @param keys     Chave XOR de cada rodada, na ordem de aplicação
+ * @param src      Origens da permutação de cada rodada
+ * @param rounds   Número de rodadas
+ */
+static void Rounds_Bitslice(BitSlice *a, BitSlice *b, int num_bits, const uint64_t *keys,
+                            const uint8_t (*src)[64], uint32_t rounds) {
+    BitSlice s[64], *t;
+
+    for (uint32_t k = 0; k < rounds; k++) {
+        for (int i = 0; i < num_bits; i++)
+            s[i] = b[i] ^ Slice_Fill(0 - ((keys[k] >> i) & 1));
+        for (int i = 0; i < num_bits; i += 8)
+            SBox_Bitslice(s + i);
+        for (int p = 0; p < num_bits; p++)
+            a[p] ^= s[src[k][p]];
+        t = a;
+        a = b;
+        b = t;
+    }
+    if (rounds & 1) {
+        memcpy(s, a, num_bits * sizeof(BitSlice));
+        memcpy(a, b, num_bits * sizeof(BitSlice));
+        memcpy(b, s, num_bits * sizeof(BitSlice));
+    }
+    SecureZero(s, sizeof(s));
+}
+
+/**
+ * @brief Cifra ou decifra grupos de CHIMA_BITSLICE_LANES blocos.
+ *
+ * A decifração é a mesma rodada com as metades trocadas e as chaves em
+ * ordem inversa.
+ *
+ * @param pCtx    Contexto
+ * @param in      Blocos de entrada
+ * @param out     Blocos de saída
+ * @param n       Quantidade de blocos
+ * @param decrypt 0 para cifrar, 1 para decifrar
+ * @return Quantidade de blocos processados
+ */
+static size_t Feistel_Blocks_Bitslice(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t n, int decrypt) {
+    uint32_t bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    size_t groups = n / CHIMA_BITSLICE_LANES;
+    uint32_t rounds = pCtx->ui32NumRounds, words[4], r;
+    const uint32_t *rk = pCtx->aui32RoundKeys;
+    uint64_t keys[CHIMA_MAX_ROUNDS], aL[CHIMA_BITSLICE_LANES], aR[CHIMA_BITSLICE_LANES], half[2];
+    uint8_t src[CHIMA_MAX_ROUNDS][64];
+    BitSlice planesL[64], planesR[64];
+
+    if (groups == 0)
+        return 0;
+
+    for (uint32_t k = 0; k < rounds; k++) {
+        r = decrypt ? rounds - 1 - k : k;
+        if (pCtx->xSize == BLOCK_MODE_64) {
+            keys[k] = rk[2 * r];
+            Permutation_Sources(rk[2 * r + 1], 32, src[k]);
+        } else {
+            keys[k] = ((uint64_t)rk[2 * r] << 32) | rk[2 * r + 1];
+            Permutation_Sources(keys[k], 64, src[k]);
+        }
+    }
+
+    for (size_t g = 0; g < groups; g++, in += CHIMA_BITSLICE_LANES * bs, out += CHIMA_BITSLICE_LANES * bs) {
+        // No modo de 64 bits as duas metades dividem uma linha da transposição
+        if (pCtx->xSize == BLOCK_MODE_64) {
+            for (int j = 0; j < CHIMA_BITSLICE_LANES; j++) {
+                BlockFromBytes(in + j * bs, words, BLOCK_MODE_64);
+                aL[j] = decrypt ? ((uint64_t)words[0] << 32) | words[1]
+                                : ((uint64_t)words[1] << 32) | words[0];
+            }
+            Slices_From_Halves(aL, planesL);
+            Rounds_Bitslice(planesL, planesL + 32, 32, keys, (const uint8_t (*)[64])src, rounds);
+            Halves_From_Slices(planesL, aL);
+            for (int j = 0; j < CHIMA_BITSLICE_LANES; j++) {
+                words[decrypt]  = (uint32_t)aL[j];
+                words[!decrypt] = (uint32_t)(aL[j] >> 32);
+                BlockToBytes(words, out + j * bs, BLOCK_MODE_64);
+            }
+        } else {
+            for (int j = 0; j < CHIMA_BITSLICE_LANES; j++) {
+                BlockFromBytes(in + j * bs, words, BLOCK_MODE_128);
+                half[0] = ((uint64_t)words[0] << 32) | words[1];
+                half[1] = ((uint64_t)words[2] << 32) | words[3];
+                aL[j] = half[decrypt];
+                aR[j] = half[!decrypt];
+            }
+            Slices_From_Halves(aL, planesL);
+            Slices_From_Halves(aR, planesR);
+            Rounds_Bitslice(planesL, planesR, 64, keys, (const uint8_t (*)[64])src, rounds);
+            Halves_From_Slices(planesL, aL);
+            Halves_From_Slices(planesR, aR);
+            for (int j = 0; j < CHIMA_BITSLICE_LANES; j++) {
+                half[decrypt]  = aL[j];
+                half[!decrypt] = aR[j];
+                words[0] = (uint32_t)(half[0] >> 32); words[1] = (uint32_t)half[0];
+                words[2] = (uint32_t)(half[1] >> 32); words[3] = (uint32_t)half[1];
+                BlockToBytes(words, out + j * bs, BLOCK_MODE_128);
+            }
+        }
+    }
+
+    SecureZero(keys, sizeof(keys));
+    SecureZero(src, sizeof(src));
+    SecureZero(planesL, sizeof(planesL));
+    SecureZero(planesR, sizeof(planesR));
+    SecureZero(aL, sizeof(aL));
+    SecureZero(aR, sizeof(aR));
+    return groups * CHIMA_BITSLICE_LANES;
+}
+
+/**
+ * @brief Cifra grupos de CHIMA_BITSLICE_LANES blocos em planos de bits.
+ *
+ * @param pCtx Contexto
+ * @param in   Blocos claros
+ * @param out  Blocos cifrados
+ * @param n    Quantidade de blocos disponíveis
+ * @return Quantidade de blocos processados
+ */
+size_t CHIMA_BITSLICE_EncryptBlocks(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t n) {
+    return Feistel_Blocks_Bitslice(pCtx, in, out, n, 0);
+}
+
+/**
+ * @brief Decifra grupos de CHIMA_BITSLICE_LANES blocos em planos de bits.
+ *
+ * @param pCtx Contexto
+ * @param in   Blocos cifrados
+ * @param out  Blocos claros
+ * @param n    Quantidade de blocos disponíveis
+ * @return Quantidade de blocos processados
+ */
+size_t CHIMA_BITSLICE_DecryptBlocks(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t n) {
+    return Feistel_Blocks_Bitslice(pCtx, in, out, n, 1);
+}
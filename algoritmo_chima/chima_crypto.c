@@ -13,12 +13,40 @@
 // INCLUSÕES //
 
 #include "chima_crypto.h"
+#include "chima_kernels.h"
+#include "chima_keycache.h"
 #include "utils.h"
+#include <stdatomic.h>
+
+
+// DEFINIÇÕES //
+
+/** Blocos processados por iteração nos laços em massa */
+#define BULK_BLOCKS 128
+/** Mensagens avançadas juntas por CHIMA_EncryptCBC_Multi e *MultiKey */
+#define MULTIKEY_LANES 512
+/** Posições da tabela de grupos por contexto (potência de 2, 4x as vias) */
+#define MULTIKEY_HASH (4 * MULTIKEY_LANES)
+/** Vias com o mesmo contexto a partir das quais o lote vai aos núcleos em massa */
+#define MULTIKEY_SHARED_LANES 4
+/** A partir daqui uma mensagem em modo paralelizável vai direto para *_Buf */
+#define MULTIKEY_DIRECT_BLOCKS 64
+/** Blocos independentes intercalados pelo núcleo escalar */
+#define INTERLEAVE_BLOCKS 4
+
+/** Expansão em linha forçada das primitivas usadas nas rodadas */
+#if defined(__GNUC__)
+#define FORCE_INLINE inline __attribute__((always_inline))
+#else
+#define FORCE_INLINE inline
+#endif
 
 
 // VARIÁVEIS GLOBAIS //
 
-static uint8_t g_num_rodadas_feistel = 22;
+// Rodadas usadas apenas pelas funções sem contexto. As funções *_Ctx e
+// CHIMA_Cipher/CHIMA_Decipher não leem nem alteram este valor.
+static _Atomic uint8_t g_num_rodadas_feistel = 22;
 
 // FUNÇÕES //
 
@@ -28,7 +56,7 @@ static uint8_t g_num_rodadas_feistel = 22;
  * @param ui8Set Quantidade de rodadas
  */
 void CHIMA_setNumberOfRounds(uint8_t ui8Set) {
-	g_num_rodadas_feistel = ui8Set;
+	atomic_store_explicit(&g_num_rodadas_feistel, ui8Set, memory_order_relaxed);
 }
 
 /**
@@ -61,13 +89,13 @@ void AESKeyExpansion(const uint8_t *key, uint8_t *expandedKeys) {
 }
 
 /**
- * @brief Aplica a S-Box AES em cada byte de um valor.
+ * @brief Aplica a S-Box AES em cada byte de um valor (tabela g_AesSBox).
  *
  * @param x         Valor de entrada
  * @param num_bytes Número de bytes válidos
  * @return Valor após substituição
  */
-uint64_t ApplySBoxAES(uint64_t x, int num_bytes) {
+static FORCE_INLINE uint64_t Apply_SBox_Table(uint64_t x, int num_bytes) {
     uint64_t result = 0;
     uint8_t byte;
     uint8_t sbox_val;
@@ -80,18 +108,18 @@ uint64_t ApplySBoxAES(uint64_t x, int num_bytes) {
 }
 
 /**
- * @brief Permuta bits de acordo com máscara fornecida.
+ * @brief Permuta bits de acordo com máscara fornecida (laço bit a bit).
  *
  * @param data     Valor original
  * @param mask     Máscara de permutação
  * @param num_bits Número de bits válidos
  * @return Valor permutado
  */
-uint64_t PermuteWithMask(uint64_t data, uint64_t mask, int num_bits) {
+static FORCE_INLINE uint64_t Permute_With_Mask_Scalar(uint64_t data, uint64_t mask, int num_bits) {
     uint64_t result = 0;
     int i = 0, j = num_bits - 1;
 
-    for (uint32_t k = 0; k < num_bits; k++) {
+    for (int k = 0; k < num_bits; k++) {
         if ((mask >> k) & 1) {
             result |= ((data >> j) & 1ULL) << k;
             j--;
@@ -104,19 +132,98 @@ uint64_t PermuteWithMask(uint64_t data, uint64_t mask, int num_bits) {
 }
 
 /**
- * @brief Função de cifragem baseada em rede Feistel.
+ * @brief ApplySBoxAES portátil.
+ */
+static uint64_t SBox_Scalar(uint64_t x, int num_bytes) {
+    return Apply_SBox_Table(x, num_bytes);
+}
+
+/**
+ * @brief PermuteWithMask portátil.
+ */
+static uint64_t Permute_Scalar(uint64_t data, uint64_t mask, int num_bits) {
+    return Permute_With_Mask_Scalar(data, mask, num_bits);
+}
+
+#if defined(CHIMA_X86_DISPATCH)
+/**
+ * @brief Aplica a S-Box AES aos 8 bytes de um valor com AESENCLAST.
+ *
+ * @param x Valor de entrada
+ * @return Valor após substituição
+ */
+static FORCE_INLINE CHIMA_TARGET("aes,ssse3") uint64_t Apply_SBox_AESNI(uint64_t x) {
+    return (uint64_t)_mm_cvtsi128_si64(CHIMA_AESNI_SBox(_mm_cvtsi64_si128((long long)x)));
+}
+
+/**
+ * @brief ApplySBoxAES com AES-NI.
+ */
+static CHIMA_TARGET("aes,ssse3") uint64_t SBox_AESNI(uint64_t x, int num_bytes) {
+    uint64_t result;
+
+    if (num_bytes <= 0)
+        return 0;
+    result = Apply_SBox_AESNI(x);
+    if (num_bytes >= 8)
+        return result;
+    return result & ((1ULL << (8 * num_bytes)) - 1);
+}
+
+/**
+ * @brief PermuteWithMask com PDEP.
+ */
+static CHIMA_TARGET("bmi2") uint64_t Permute_BMI2(uint64_t data, uint64_t mask, int num_bits) {
+    return CHIMA_BMI2_Permute(data, mask, num_bits);
+}
+#endif
+
+/**
+ * @brief Aplica a S-Box AES em cada byte de um valor.
+ *
+ * Usa AESENCLAST quando o processador tem AES-NI e SSSE3 e a tabela
+ * g_AesSBox nos demais casos.
+ *
+ * @param x         Valor de entrada
+ * @param num_bytes Número de bytes válidos
+ * @return Valor após substituição
+ */
+uint64_t ApplySBoxAES(uint64_t x, int num_bytes) {
+    return CHIMA_GetDispatch()->pfnApplySBox(x, num_bytes);
+}
+
+/**
+ * @brief Permuta bits de acordo com máscara fornecida.
+ *
+ * Usa PDEP quando o processador tem BMI2 e o laço bit a bit nos demais
+ * casos.
+ *
+ * @param data     Valor original
+ * @param mask     Máscara de permutação
+ * @param num_bits Número de bits válidos
+ * @return Valor permutado
+ */
+uint64_t PermuteWithMask(uint64_t data, uint64_t mask, int num_bits) {
+    if (num_bits <= 0)
+        return 0;
+    return CHIMA_GetDispatch()->pfnPermute(data, mask, num_bits);
+}
+
+/**
+ * @brief Rede Feistel de cifragem com as primitivas do despacho, em laço.
  *
  * @param block     Bloco de entrada/saída
  * @param roundKeys Chaves de rodada
  * @param mode      Tamanho do bloco
+ * @param rounds    Número de rodadas
  */
-void FeistelEncrypt(uint32_t *block, const uint32_t *roundKeys, BlockCipherSize mode) {
+static void Feistel_Encrypt_Loop(uint32_t *block, const uint32_t *roundKeys, BlockCipherSize mode, uint32_t rounds) {
     if (mode == BLOCK_MODE_64) {
         uint32_t L = block[0], R = block[1];
         uint32_t K1, K2;
 		uint32_t temp;
         uint32_t sbox;
-        for (uint32_t i = 0; i < g_num_rodadas_feistel; i++) {
+        for (uint32_t i = 0; i < rounds; i++) {
             K1 = roundKeys[2 * i];
             K2 = roundKeys[2 * i + 1];
             temp = R;
@@ -130,7 +237,7 @@ void FeistelEncrypt(uint32_t *block, const uint32_t *roundKeys, BlockCipherSize
         uint32_t L0 = block[0], L1 = block[1], R0 = block[2], R1 = block[3];
         uint64_t R, K, S, P;
         uint32_t temp0, temp1;
-        for (uint32_t i = 0; i < g_num_rodadas_feistel; i++) {
+        for (uint32_t i = 0; i < rounds; i++) {
             R = ((uint64_t)R0 << 32) | R1;
             K = ((uint64_t)roundKeys[2 * i] << 32) | roundKeys[2 * i + 1];
             S = ApplySBoxAES(R ^ K, 8);
@@ -148,19 +255,20 @@ void FeistelEncrypt(uint32_t *block, const uint32_t *roundKeys, BlockCipherSize
 }
 
 /**
- * @brief Processo inverso da rede Feistel para decifração.
+ * @brief Rede Feistel de decifração com as primitivas do despacho, em laço.
  *
  * @param block     Bloco a decifrar
  * @param roundKeys Chaves de rodada
  * @param mode      Tamanho do bloco
+ * @param rounds    Número de rodadas
  */
-void FeistelDecrypt(uint32_t *block, const uint32_t *roundKeys, BlockCipherSize mode) {
+static void Feistel_Decrypt_Loop(uint32_t *block, const uint32_t *roundKeys, BlockCipherSize mode, uint32_t rounds) {
     if (mode == BLOCK_MODE_64) {
         uint32_t L = block[0], R = block[1];
         uint32_t K1, K2;
 		uint32_t temp;
         uint32_t sbox;
-        for (int32_t i = g_num_rodadas_feistel - 1; i >= 0; --i) {
+        for (int32_t i = (int32_t)rounds - 1; i >= 0; --i) {
             K1 = roundKeys[2 * i];
             K2 = roundKeys[2 * i + 1];
             temp = L;
@@ -174,7 +282,7 @@ void FeistelDecrypt(uint32_t *block, const uint32_t *roundKeys, BlockCipherSize
         uint32_t L0 = block[0], L1 = block[1], R0 = block[2], R1 = block[3];
         uint64_t R, K, S, P;
         uint32_t temp0, temp1;
-        for (int32_t i = g_num_rodadas_feistel - 1; i >= 0; --i) {
+        for (int32_t i = (int32_t)rounds - 1; i >= 0; --i) {
             R = ((uint64_t)L0 << 32) | L1;
             K = ((uint64_t)roundKeys[2 * i] << 32) | roundKeys[2 * i + 1];
             S = ApplySBoxAES(R ^ K, 8);
@@ -191,295 +299,1954 @@ void FeistelDecrypt(uint32_t *block, const uint32_t *roundKeys, BlockCipherSize
     }
 }
 
-/**
- * @brief Interface genérica para cifrar blocos
- * 
- * @param pt 
- * @param key 
- * @param iv 
- * @param ct 
- * @param xSize 
- * @param xMode
- * @param ui32NumRounds 
+#if !defined(CHIMA_NO_UNROLLED_ROUNDS)
+
+/*
+ * Redes Feistel totalmente desenroladas para cada número de rodadas
+ * aceito pelo contexto (CHIMA_MIN_ROUNDS a CHIMA_MAX_ROUNDS). Os índices
+ * das chaves de rodada são constantes e o compilador pode escalonar
+ * instruções entre rodadas. Cada conjunto é gerado uma vez com as
+ * primitivas portáteis e, em x86-64, outra vez com AES-NI e PDEP em
+ * linha. Compile com -DCHIMA_NO_UNROLLED_ROUNDS para reduzir o tamanho
+ * do código em alvos com pouca memória.
  */
-void CHIMA_Cipher(const uint8_t *plaintext, const uint8_t *key, const uint8_t *iv,
-     uint8_t *ciphertext, BlockCipherSize xSize, CipherMode xMode, uint32_t ui32NumRounds) {
 
-    // Atualiza o número de rodadas se possível
-    if (ui32NumRounds >= 9 && ui32NumRounds <= 22) {
-        CHIMA_setNumberOfRounds(ui32NumRounds);
-    } else PRINT_Write("Número de rodadas inválido. Usando última configuração.\n", 53);
+#define UNROLL_1(M) M(0)
+#define UNROLL_2(M) UNROLL_1(M) M(1)
+#define UNROLL_3(M) UNROLL_2(M) M(2)
+#define UNROLL_4(M) UNROLL_3(M) M(3)
+#define UNROLL_5(M) UNROLL_4(M) M(4)
+#define UNROLL_6(M) UNROLL_5(M) M(5)
+#define UNROLL_7(M) UNROLL_6(M) M(6)
+#define UNROLL_8(M) UNROLL_7(M) M(7)
+#define UNROLL_9(M) UNROLL_8(M) M(8)
+#define UNROLL_10(M) UNROLL_9(M) M(9)
+#define UNROLL_11(M) UNROLL_10(M) M(10)
+#define UNROLL_12(M) UNROLL_11(M) M(11)
+#define UNROLL_13(M) UNROLL_12(M) M(12)
+#define UNROLL_14(M) UNROLL_13(M) M(13)
+#define UNROLL_15(M) UNROLL_14(M) M(14)
+#define UNROLL_16(M) UNROLL_15(M) M(15)
+#define UNROLL_17(M) UNROLL_16(M) M(16)
+#define UNROLL_18(M) UNROLL_17(M) M(17)
+#define UNROLL_19(M) UNROLL_18(M) M(18)
+#define UNROLL_20(M) UNROLL_19(M) M(19)
+#define UNROLL_21(M) UNROLL_20(M) M(20)
+#define UNROLL_22(M) UNROLL_21(M) M(21)
 
-    switch (xMode) {
-        case CIPHER_MODE_ECB: CHIMA_EncryptECB(plaintext, key,     ciphertext, xSize); break;
-        case CIPHER_MODE_CBC: CHIMA_EncryptCBC(plaintext, key, iv, ciphertext, xSize); break;
-        case CIPHER_MODE_CFB: CHIMA_EncryptCFB(plaintext, key, iv, ciphertext, xSize); break;
-        case CIPHER_MODE_OFB: CHIMA_EncryptOFB(plaintext, key, iv, ciphertext, xSize); break;
-        case CIPHER_MODE_CTR: CHIMA_EncryptCTR(plaintext, key, iv, ciphertext, xSize); break;
-    }
+/* ROUND_SBOX32/64 e ROUND_PERM são definidos antes de cada conjunto */
+#define ENC64_ROUND(i) \
+    t = R; R = L ^ (uint32_t)ROUND_PERM(ROUND_SBOX32(R ^ rk[2 * (i)]), rk[2 * (i) + 1], 32); L = t;
+#define DEC64_ROUND(i) \
+    t = L; L = R ^ (uint32_t)ROUND_PERM(ROUND_SBOX32(L ^ last[-2 * (i)]), last[-2 * (i) + 1], 32); R = t;
+#define ENC128_ROUND(i) \
+    K = ((uint64_t)rk[2 * (i)] << 32) | rk[2 * (i) + 1]; \
+    t = R; R = L ^ ROUND_PERM(ROUND_SBOX64(R ^ K), K, 64); L = t;
+#define DEC128_ROUND(i) \
+    K = ((uint64_t)last[-2 * (i)] << 32) | last[-2 * (i) + 1]; \
+    t = L; L = R ^ ROUND_PERM(ROUND_SBOX64(L ^ K), K, 64); R = t;
+
+#define DEFINE_FIXED_ROUNDS(N, SFX, ATTR) \
+static ATTR void Feistel_Encrypt64_##N##SFX(uint32_t *block, const uint32_t *rk) { \
+    uint32_t L = block[0], R = block[1], t; \
+    UNROLL_##N(ENC64_ROUND) \
+    block[0] = L; block[1] = R; \
+} \
+static ATTR void Feistel_Decrypt64_##N##SFX(uint32_t *block, const uint32_t *rk) { \
+    const uint32_t *last = rk + 2 * ((N) - 1); \
+    uint32_t L = block[0], R = block[1], t; \
+    UNROLL_##N(DEC64_ROUND) \
+    block[0] = L; block[1] = R; \
+} \
+static ATTR void Feistel_Encrypt128_##N##SFX(uint32_t *block, const uint32_t *rk) { \
+    uint64_t L = ((uint64_t)block[0] << 32) | block[1]; \
+    uint64_t R = ((uint64_t)block[2] << 32) | block[3]; \
+    uint64_t K, t; \
+    UNROLL_##N(ENC128_ROUND) \
+    block[0] = (uint32_t)(L >> 32); block[1] = (uint32_t)L; \
+    block[2] = (uint32_t)(R >> 32); block[3] = (uint32_t)R; \
+} \
+static ATTR void Feistel_Decrypt128_##N##SFX(uint32_t *block, const uint32_t *rk) { \
+    const uint32_t *last = rk + 2 * ((N) - 1); \
+    uint64_t L = ((uint64_t)block[0] << 32) | block[1]; \
+    uint64_t R = ((uint64_t)block[2] << 32) | block[3]; \
+    uint64_t K, t; \
+    UNROLL_##N(DEC128_ROUND) \
+    block[0] = (uint32_t)(L >> 32); block[1] = (uint32_t)L; \
+    block[2] = (uint32_t)(R >> 32); block[3] = (uint32_t)R; \
 }
 
-/**
- * @brief Interface genérica para decifrar blocos
- * 
- * @param ct 
- * @param key 
- * @param iv 
- * @param pt 
- * @param xSize 
- * @param xMode
- * @param ui32NumRounds
- */
-void CHIMA_Decipher(const uint8_t *ciphertext, const uint8_t *key, const uint8_t *iv,
-     uint8_t *decrypted, BlockCipherSize xSize, CipherMode xMode, uint32_t ui32NumRounds) {
+#define DEFINE_ALL_FIXED_ROUNDS(SFX, ATTR) \
+    DEFINE_FIXED_ROUNDS(9, SFX, ATTR)  DEFINE_FIXED_ROUNDS(10, SFX, ATTR) \
+    DEFINE_FIXED_ROUNDS(11, SFX, ATTR) DEFINE_FIXED_ROUNDS(12, SFX, ATTR) \
+    DEFINE_FIXED_ROUNDS(13, SFX, ATTR) DEFINE_FIXED_ROUNDS(14, SFX, ATTR) \
+    DEFINE_FIXED_ROUNDS(15, SFX, ATTR) DEFINE_FIXED_ROUNDS(16, SFX, ATTR) \
+    DEFINE_FIXED_ROUNDS(17, SFX, ATTR) DEFINE_FIXED_ROUNDS(18, SFX, ATTR) \
+    DEFINE_FIXED_ROUNDS(19, SFX, ATTR) DEFINE_FIXED_ROUNDS(20, SFX, ATTR) \
+    DEFINE_FIXED_ROUNDS(21, SFX, ATTR) DEFINE_FIXED_ROUNDS(22, SFX, ATTR)
 
-    // Atualiza o número de rodadas se possível
-    if (ui32NumRounds >= 9 && ui32NumRounds <= 22) {
-        CHIMA_setNumberOfRounds(ui32NumRounds);
-    } else PRINT_Write("Número de rodadas inválido. Usando última configuração.\n", 53);
+/* Linha de uma tabela de redes: uma entrada por número de rodadas */
+#define FIXED_ROUNDS_ROW(NAME, SFX) { \
+    NAME##9##SFX,  NAME##10##SFX, NAME##11##SFX, NAME##12##SFX, NAME##13##SFX, NAME##14##SFX, NAME##15##SFX, \
+    NAME##16##SFX, NAME##17##SFX, NAME##18##SFX, NAME##19##SFX, NAME##20##SFX, NAME##21##SFX, NAME##22##SFX }
 
-    switch (xMode) {
-        case CIPHER_MODE_ECB: CHIMA_DecryptECB(ciphertext, key,     decrypted, xSize); break;
-        case CIPHER_MODE_CBC: CHIMA_DecryptCBC(ciphertext, key, iv, decrypted, xSize); break;
-        case CIPHER_MODE_CFB: CHIMA_DecryptCFB(ciphertext, key, iv, decrypted, xSize); break;
-        case CIPHER_MODE_OFB: CHIMA_DecryptOFB(ciphertext, key, iv, decrypted, xSize); break;
-        case CIPHER_MODE_CTR: CHIMA_DecryptCTR(ciphertext, key, iv, decrypted, xSize); break;
-    }
-}
+/** Rede desenrolada para um número fixo de rodadas */
+typedef void (*FixedRoundsFn)(uint32_t *block, const uint32_t *rk);
 
+#define ROUND_SBOX32(x) Apply_SBox_Table((x), 4)
+#define ROUND_SBOX64(x) Apply_SBox_Table((x), 8)
+#define ROUND_PERM      Permute_With_Mask_Scalar
+DEFINE_ALL_FIXED_ROUNDS(_Scalar, )
+#undef ROUND_SBOX32
+#undef ROUND_SBOX64
+#undef ROUND_PERM
 
-// MODO DE CIFRA //
+/** Redes portáteis de cifragem, indexadas por [modo][rodadas - CHIMA_MIN_ROUNDS] */
+static const FixedRoundsFn g_apfnEncryptScalar[2][CHIMA_MAX_ROUNDS - CHIMA_MIN_ROUNDS + 1] = {
+    FIXED_ROUNDS_ROW(Feistel_Encrypt64_, _Scalar), FIXED_ROUNDS_ROW(Feistel_Encrypt128_, _Scalar)
+};
+
+/** Redes portáteis de decifração, indexadas por [modo][rodadas - CHIMA_MIN_ROUNDS] */
+static const FixedRoundsFn g_apfnDecryptScalar[2][CHIMA_MAX_ROUNDS - CHIMA_MIN_ROUNDS + 1] = {
+    FIXED_ROUNDS_ROW(Feistel_Decrypt64_, _Scalar), FIXED_ROUNDS_ROW(Feistel_Decrypt128_, _Scalar)
+};
+
+#if defined(CHIMA_X86_DISPATCH)
+#define ROUND_SBOX32(x) (uint32_t)Apply_SBox_AESNI(x)
+#define ROUND_SBOX64(x) Apply_SBox_AESNI(x)
+#define ROUND_PERM      CHIMA_BMI2_Permute
+DEFINE_ALL_FIXED_ROUNDS(_Fast, CHIMA_TARGET("bmi2,aes,ssse3"))
+#undef ROUND_SBOX32
+#undef ROUND_SBOX64
+#undef ROUND_PERM
+
+/** Redes AES-NI + BMI2 de cifragem, indexadas por [modo][rodadas - CHIMA_MIN_ROUNDS] */
+static const FixedRoundsFn g_apfnEncryptFast[2][CHIMA_MAX_ROUNDS - CHIMA_MIN_ROUNDS + 1] = {
+    FIXED_ROUNDS_ROW(Feistel_Encrypt64_, _Fast), FIXED_ROUNDS_ROW(Feistel_Encrypt128_, _Fast)
+};
+
+/** Redes AES-NI + BMI2 de decifração, indexadas por [modo][rodadas - CHIMA_MIN_ROUNDS] */
+static const FixedRoundsFn g_apfnDecryptFast[2][CHIMA_MAX_ROUNDS - CHIMA_MIN_ROUNDS + 1] = {
+    FIXED_ROUNDS_ROW(Feistel_Decrypt64_, _Fast), FIXED_ROUNDS_ROW(Feistel_Decrypt128_, _Fast)
+};
+#endif
+
+#endif /* CHIMA_NO_UNROLLED_ROUNDS */
 
 /**
- * @brief Expande a chave mestra em chaves de rodada de 32 bits.
- *
- * @param key         Chave de 128 bits
- * @param roundKeys32 Vetor de saída
+ * @brief Motor de cifragem portátil (pfnEncryptRounds).
  */
-static void Expand_Round_Keys(const uint8_t *key, uint32_t *roundKeys32) {
-    uint8_t expandedKey[176] = {0};
-    AESKeyExpansion(key, expandedKey);
+static void Feistel_Encrypt_Scalar(uint32_t *block, const uint32_t *roundKeys, BlockCipherSize mode, uint32_t rounds) {
+#if !defined(CHIMA_NO_UNROLLED_ROUNDS)
+    if (rounds >= CHIMA_MIN_ROUNDS && rounds <= CHIMA_MAX_ROUNDS) {
+        g_apfnEncryptScalar[mode != BLOCK_MODE_64][rounds - CHIMA_MIN_ROUNDS](block, roundKeys);
+        return;
+    }
+#endif
+    Feistel_Encrypt_Loop(block, roundKeys, mode, rounds);
+}
 
-    for (uint32_t k = 0; k < 44; k++) {
-        roundKeys32[k] = ((uint32_t)expandedKey[k * 4]     << 24) |
-                         ((uint32_t)expandedKey[k * 4 + 1] << 16) |
-                         ((uint32_t)expandedKey[k * 4 + 2] << 8)  |
-                         ((uint32_t)expandedKey[k * 4 + 3]);
+/**
+ * @brief Motor de decifração portátil (pfnDecryptRounds).
+ */
+static void Feistel_Decrypt_Scalar(uint32_t *block, const uint32_t *roundKeys, BlockCipherSize mode, uint32_t rounds) {
+#if !defined(CHIMA_NO_UNROLLED_ROUNDS)
+    if (rounds >= CHIMA_MIN_ROUNDS && rounds <= CHIMA_MAX_ROUNDS) {
+        g_apfnDecryptScalar[mode != BLOCK_MODE_64][rounds - CHIMA_MIN_ROUNDS](block, roundKeys);
+        return;
     }
+#endif
+    Feistel_Decrypt_Loop(block, roundKeys, mode, rounds);
 }
 
+#if defined(CHIMA_X86_DISPATCH) && !defined(CHIMA_NO_UNROLLED_ROUNDS)
 /**
- * @brief Cifra um único bloco.
- *
- * @param input  Dados de entrada
- * @param rk     Chaves expandidas
- * @param output Buffer de saída
- * @param mode   Tamanho do bloco
+ * @brief Motor de cifragem com AES-NI e BMI2 (pfnEncryptRounds).
  */
-static void Block_Encrypt(const uint8_t *input, const uint32_t *rk, uint8_t *output, BlockCipherSize mode) {
-    uint32_t block[4] = {0};
-    BlockFromBytes(input, block, mode);
-    FeistelEncrypt(block, rk, mode);
-    BlockToBytes(block, output, mode);
+static void Feistel_Encrypt_Fast(uint32_t *block, const uint32_t *roundKeys, BlockCipherSize mode, uint32_t rounds) {
+    if (rounds >= CHIMA_MIN_ROUNDS && rounds <= CHIMA_MAX_ROUNDS) {
+        g_apfnEncryptFast[mode != BLOCK_MODE_64][rounds - CHIMA_MIN_ROUNDS](block, roundKeys);
+        return;
+    }
+    Feistel_Encrypt_Loop(block, roundKeys, mode, rounds);
 }
 
 /**
- * @brief Decifra um único bloco.
- *
- * @param input  Dados cifrados
- * @param rk     Chaves expandidas
- * @param output Buffer de saída
- * @param mode   Tamanho do bloco
+ * @brief Motor de decifração com AES-NI e BMI2 (pfnDecryptRounds).
  */
-static void Block_Decrypt(const uint8_t *input, const uint32_t *rk, uint8_t *output, BlockCipherSize mode) {
-    uint32_t block[4] = {0};
-    BlockFromBytes(input, block, mode);
-    FeistelDecrypt(block, rk, mode);
-    BlockToBytes(block, output, mode);
+static void Feistel_Decrypt_Fast(uint32_t *block, const uint32_t *roundKeys, BlockCipherSize mode, uint32_t rounds) {
+    if (rounds >= CHIMA_MIN_ROUNDS && rounds <= CHIMA_MAX_ROUNDS) {
+        g_apfnDecryptFast[mode != BLOCK_MODE_64][rounds - CHIMA_MIN_ROUNDS](block, roundKeys);
+        return;
+    }
+    Feistel_Decrypt_Loop(block, roundKeys, mode, rounds);
 }
+#endif
 
 /**
- * @brief Copia bytes para um buffer auxiliar.
+ * @brief Escolhe as primitivas e os motores de rodada do CHIMA.
  *
- * @param src Fonte
- * @param dst Destino
- * @param len Quantidade de bytes
+ * @param pDispatch Tabela em construção, com ui32Features preenchido
  */
-static void Load_Block(const uint8_t *src, uint8_t *dst, uint32_t len) {
-    for (uint32_t i = 0; i < len; i++)
-    	dst[i] = src[i];
-}
+void CHIMA_BindCrypto(CHIMA_Dispatch *pDispatch) {
+    uint32_t features = pDispatch->ui32Features;
 
-// OPERATION MODES //
+    pDispatch->pfnApplySBox     = SBox_Scalar;
+    pDispatch->pfnPermute       = Permute_Scalar;
+    pDispatch->pfnEncryptRounds = Feistel_Encrypt_Scalar;
+    pDispatch->pfnDecryptRounds = Feistel_Decrypt_Scalar;
+#if defined(CHIMA_X86_DISPATCH)
+    if ((features & (CHIMA_CPU_SSSE3 | CHIMA_CPU_AESNI)) == (CHIMA_CPU_SSSE3 | CHIMA_CPU_AESNI))
+        pDispatch->pfnApplySBox = SBox_AESNI;
+    if (features & CHIMA_CPU_BMI2)
+        pDispatch->pfnPermute = Permute_BMI2;
+#if defined(CHIMA_HAVE_AESNI)
+    if ((features & CHIMA_CPU_FAST_ROUNDS) == CHIMA_CPU_FAST_ROUNDS) {
+        pDispatch->pfnEncryptMultiKey = CHIMA_AESNI_EncryptMultiKey;
+        pDispatch->pfnDecryptMultiKey = CHIMA_AESNI_DecryptMultiKey;
+    }
+#endif
+#if !defined(CHIMA_NO_UNROLLED_ROUNDS)
+    if ((features & CHIMA_CPU_FAST_ROUNDS) == CHIMA_CPU_FAST_ROUNDS) {
+        pDispatch->pfnEncryptRounds = Feistel_Encrypt_Fast;
+        pDispatch->pfnDecryptRounds = Feistel_Decrypt_Fast;
+    }
+#endif
+#else
+    (void)features;
+#endif
+}
 
 /**
- * @brief Modo ECB - Encrypt
+ * @brief Rede Feistel de cifragem com número de rodadas explícito.
  *
- * @param plaintext
- * @param key
- * @param ciphertext
- * @param mode
+ * @param block     Bloco de entrada/saída
+ * @param roundKeys Chaves de rodada
+ * @param mode      Tamanho do bloco
+ * @param rounds    Número de rodadas
  */
-void CHIMA_EncryptECB(const uint8_t *plaintext, const uint8_t *key, uint8_t *ciphertext, BlockCipherSize mode) {
-    uint32_t rk[44];
-    Expand_Round_Keys(key, rk);
-    Block_Encrypt(plaintext, rk, ciphertext, mode);
+static inline void Feistel_Encrypt_Rounds(uint32_t *block, const uint32_t *roundKeys, BlockCipherSize mode, uint32_t rounds) {
+    CHIMA_GetDispatch()->pfnEncryptRounds(block, roundKeys, mode, rounds);
 }
 
 /**
- * @brief Modo ECB - Decrypt
+ * @brief Rede Feistel de decifração com número de rodadas explícito.
  *
- * @param ciphertext
- * @param key
- * @param plaintext
- * @param mode
+ * @param block     Bloco a decifrar
+ * @param roundKeys Chaves de rodada
+ * @param mode      Tamanho do bloco
+ * @param rounds    Número de rodadas
  */
-void CHIMA_DecryptECB(const uint8_t *ciphertext, const uint8_t *key, uint8_t *plaintext, BlockCipherSize mode) {
-    uint32_t rk[44];
-    Expand_Round_Keys(key, rk);
-    Block_Decrypt(ciphertext, rk, plaintext, mode);
+static inline void Feistel_Decrypt_Rounds(uint32_t *block, const uint32_t *roundKeys, BlockCipherSize mode, uint32_t rounds) {
+    CHIMA_GetDispatch()->pfnDecryptRounds(block, roundKeys, mode, rounds);
 }
 
 /**
- * @brief Modo CBC - Encrypt
+ * @brief Função de cifragem baseada em rede Feistel.
  *
- * @param pt
- * @param key
- * @param iv
- * @param ct
- * @param mode
+ * @param block     Bloco de entrada/saída
+ * @param roundKeys Chaves de rodada
+ * @param mode      Tamanho do bloco
  */
-void CHIMA_EncryptCBC(const uint8_t *pt, const uint8_t *key, const uint8_t *iv, uint8_t *ct, BlockCipherSize mode) {
-	uint32_t bs = (mode == BLOCK_MODE_64) ? 8 : 16;
-    uint8_t iv_local[16] = {0}, xor_buf[16] = {0};
-
-    Load_Block(iv, iv_local, bs);
-    XOR_Blocks(xor_buf, pt, iv_local, bs);
-
-    uint32_t rk[44] = {0};
-    Expand_Round_Keys(key, rk);
-    Block_Encrypt(xor_buf, rk, ct, mode);
+void FeistelEncrypt(uint32_t *block, const uint32_t *roundKeys, BlockCipherSize mode) {
+    Feistel_Encrypt_Rounds(block, roundKeys, mode,
+                           atomic_load_explicit(&g_num_rodadas_feistel, memory_order_relaxed));
 }
 
 /**
- * @brief Modo CBC - Decrypt
+ * @brief Processo inverso da rede Feistel para decifração.
  *
- * @param ct
- * @param key
- * @param iv
- * @param pt
- * @param mode
+ * @param block     Bloco a decifrar
+ * @param roundKeys Chaves de rodada
+ * @param mode      Tamanho do bloco
  */
-void CHIMA_DecryptCBC(const uint8_t *ct, const uint8_t *key, const uint8_t *iv, uint8_t *pt, BlockCipherSize mode) {
-	uint32_t bs = (mode == BLOCK_MODE_64) ? 8 : 16;
-    uint8_t iv_local[16] = {0}, temp[16] = {0};
-
-    Load_Block(iv, iv_local, bs);
-
-    uint32_t rk[44] = {0};
-    Expand_Round_Keys(key, rk);
-    Block_Decrypt(ct, rk, temp, mode);
-    XOR_Blocks(pt, temp, iv_local, bs);
+void FeistelDecrypt(uint32_t *block, const uint32_t *roundKeys, BlockCipherSize mode) {
+    Feistel_Decrypt_Rounds(block, roundKeys, mode,
+                           atomic_load_explicit(&g_num_rodadas_feistel, memory_order_relaxed));
 }
 
 /**
- * @brief Modo CFB - Encrypt
+ * @brief Combina as tabelas de uma rodada para os bytes de um valor.
  *
- * @param pt
- * @param key
- * @param iv
- * @param ct
- * @param mode
+ * @param table  Tabelas da rodada (num_bytes x 256 entradas)
+ * @param x      Valor de entrada
+ * @param num_bytes Número de bytes válidos
+ * @return OU das entradas selecionadas por cada byte
  */
-void CHIMA_EncryptCFB(const uint8_t *pt, const uint8_t *key, const uint8_t *iv, uint8_t *ct, BlockCipherSize mode) {
-	uint32_t bs = (mode == BLOCK_MODE_64) ? 8 : 16;
-    uint8_t feedback[16] = {0}, stream[16] = {0};
-
-    Load_Block(iv, feedback, bs);
-
-    uint32_t rk[44];
-    Expand_Round_Keys(key, rk);
-    Block_Encrypt(feedback, rk, stream, mode);
-    XOR_Blocks(ct, pt, stream, bs);
+static inline uint64_t Table_Lookup(const uint64_t *table, uint64_t x, int num_bytes) {
+    uint64_t result = 0;
+    for (int b = 0; b < num_bytes; b++)
+        result |= table[b * 256 + ((x >> (8 * b)) & 0xFF)];
+    return result;
 }
 
 /**
- * @brief Modo CFB - Decrypt
+ * @brief Rede Feistel de cifragem usando as tabelas do contexto.
  *
- * @param ct
- * @param key
- * @param iv
- * @param pt
- * @param mode
+ * Com CHIMA_TABLES_PERM a S-Box é aplicada e só a permutação vem das
+ * tabelas; com CHIMA_TABLES_TTABLE a função de rodada inteira é o OU das
+ * entradas indexadas pelos bytes da metade direita.
+ *
+ * @param block Bloco de entrada/saída
+ * @param pCtx  Contexto com tabelas
  */
-void CHIMA_DecryptCFB(const uint8_t *ct, const uint8_t *key, const uint8_t *iv, uint8_t *pt, BlockCipherSize mode) {
-    CHIMA_EncryptCFB(ct, key, iv, pt, mode);
+static void Feistel_Encrypt_Tables(uint32_t *block, const CHIMA_Ctx *pCtx) {
+    const uint32_t *roundKeys = pCtx->aui32RoundKeys;
+    const uint64_t *table = pCtx->pui64Tables;
+    int fused = (pCtx->xTableMode == CHIMA_TABLES_TTABLE);
+
+    if (pCtx->xSize == BLOCK_MODE_64) {
+        uint32_t L = block[0], R = block[1], temp;
+        uint64_t x;
+        for (uint32_t i = 0; i < pCtx->ui32NumRounds; i++, table += 4 * 256) {
+            x = fused ? R : ApplySBoxAES(R ^ roundKeys[2 * i], 4);
+            temp = R;
+            R = L ^ (uint32_t)Table_Lookup(table, x, 4);
+            L = temp;
+        }
+        block[0] = L;
+        block[1] = R;
+    } else {
+        uint64_t L = ((uint64_t)block[0] << 32) | block[1];
+        uint64_t R = ((uint64_t)block[2] << 32) | block[3];
+        uint64_t K, x, temp;
+        for (uint32_t i = 0; i < pCtx->ui32NumRounds; i++, table += 8 * 256) {
+            K = ((uint64_t)roundKeys[2 * i] << 32) | roundKeys[2 * i + 1];
+            x = fused ? R : ApplySBoxAES(R ^ K, 8);
+            temp = R;
+            R = L ^ Table_Lookup(table, x, 8);
+            L = temp;
+        }
+        block[0] = (uint32_t)(L >> 32); block[1] = (uint32_t)L;
+        block[2] = (uint32_t)(R >> 32); block[3] = (uint32_t)R;
+    }
 }
 
 /**
- * @brief Modo OFB - Encrypt
+ * @brief Rede Feistel de decifração usando as tabelas do contexto.
  *
- * @param pt
- * @param key
- * @param iv
- * @param ct
- * @param mode
+ * @param block Bloco a decifrar
+ * @param pCtx  Contexto com tabelas
  */
-void CHIMA_EncryptOFB(const uint8_t *pt, const uint8_t *key, const uint8_t *iv, uint8_t *ct, BlockCipherSize mode) {
-	uint32_t bs = (mode == BLOCK_MODE_64) ? 8 : 16;
-    uint8_t stream[16] = {0}, output_block[16] = {0};
-
-    Load_Block(iv, output_block, bs);
+static void Feistel_Decrypt_Tables(uint32_t *block, const CHIMA_Ctx *pCtx) {
+    const uint32_t *roundKeys = pCtx->aui32RoundKeys;
+    const uint64_t *table;
+    int fused = (pCtx->xTableMode == CHIMA_TABLES_TTABLE);
 
-    uint32_t rk[44];
-    Expand_Round_Keys(key, rk);
-    Block_Encrypt(output_block, rk, stream, mode);
-    XOR_Blocks(ct, pt, stream, bs);
+    if (pCtx->xSize == BLOCK_MODE_64) {
+        uint32_t L = block[0], R = block[1], temp;
+        uint64_t x;
+        for (int32_t i = (int32_t)pCtx->ui32NumRounds - 1; i >= 0; --i) {
+            table = pCtx->pui64Tables + (size_t)i * 4 * 256;
+            x = fused ? L : ApplySBoxAES(L ^ roundKeys[2 * i], 4);
+            temp = L;
+            L = R ^ (uint32_t)Table_Lookup(table, x, 4);
+            R = temp;
+        }
+        block[0] = L;
+        block[1] = R;
+    } else {
+        uint64_t L = ((uint64_t)block[0] << 32) | block[1];
+        uint64_t R = ((uint64_t)block[2] << 32) | block[3];
+        uint64_t K, x, temp;
+        for (int32_t i = (int32_t)pCtx->ui32NumRounds - 1; i >= 0; --i) {
+            table = pCtx->pui64Tables + (size_t)i * 8 * 256;
+            K = ((uint64_t)roundKeys[2 * i] << 32) | roundKeys[2 * i + 1];
+            x = fused ? L : ApplySBoxAES(L ^ K, 8);
+            temp = L;
+            L = R ^ Table_Lookup(table, x, 8);
+            R = temp;
+        }
+        block[0] = (uint32_t)(L >> 32); block[1] = (uint32_t)L;
+        block[2] = (uint32_t)(R >> 32); block[3] = (uint32_t)R;
+    }
 }
 
 /**
- * @brief Modo OFB - Decrypt
+ * @brief Cifra um bloco com o motor correspondente às tabelas do contexto.
  *
- * @param ct
- * @param key
- * @param iv
- * @param pt
- * @param mode
+ * @param pCtx  Contexto
+ * @param block Bloco de entrada/saída
  */
-void CHIMA_DecryptOFB(const uint8_t *ct, const uint8_t *key, const uint8_t *iv, uint8_t *pt, BlockCipherSize mode) {
-    CHIMA_EncryptOFB(ct, key, iv, pt, mode);
+static void Feistel_Encrypt_Ctx(const CHIMA_Ctx *pCtx, uint32_t *block) {
+    switch (pCtx->xTableMode) {
+        case CHIMA_TABLES_PERM:
+        case CHIMA_TABLES_TTABLE: Feistel_Encrypt_Tables(block, pCtx); break;
+        default: Feistel_Encrypt_Rounds(block, pCtx->aui32RoundKeys, pCtx->xSize, pCtx->ui32NumRounds); break;
+    }
 }
 
 /**
- * @brief Modo CTR - Encrypt
+ * @brief Decifra um bloco com o motor correspondente às tabelas do contexto.
  *
- * @param pt
- * @param key
- * @param iv
+ * @param pCtx  Contexto
+ * @param block Bloco de entrada/saída
+ */
+static void Feistel_Decrypt_Ctx(const CHIMA_Ctx *pCtx, uint32_t *block) {
+    switch (pCtx->xTableMode) {
+        case CHIMA_TABLES_PERM:
+        case CHIMA_TABLES_TTABLE: Feistel_Decrypt_Tables(block, pCtx); break;
+        default: Feistel_Decrypt_Rounds(block, pCtx->aui32RoundKeys, pCtx->xSize, pCtx->ui32NumRounds); break;
+    }
+}
+
+/**
+ * @brief Expande a chave mestra em chaves de rodada de 32 bits.
+ *
+ * @param key         Chave de 128 bits
+ * @param roundKeys32 Vetor de saída
+ */
+static void Expand_Round_Keys(const uint8_t *key, uint32_t *roundKeys32) {
+    uint8_t expandedKey[176] = {0};
+    AESKeyExpansion(key, expandedKey);
+
+    for (uint32_t k = 0; k < 44; k++) {
+        roundKeys32[k] = ((uint32_t)expandedKey[k * 4]     << 24) |
+                         ((uint32_t)expandedKey[k * 4 + 1] << 16) |
+                         ((uint32_t)expandedKey[k * 4 + 2] << 8)  |
+                         ((uint32_t)expandedKey[k * 4 + 3]);
+    }
+}
+
+/**
+ * @brief Expande a chave passando pelo cache de chaves expandidas.
+ *
+ * Com o cache desligado, equivale a Expand_Round_Keys.
+ *
+ * @param key         Chave de 128 bits
+ * @param roundKeys32 Vetor de saída
+ */
+static void Expand_Round_Keys_Cached(const uint8_t *key, uint32_t *roundKeys32) {
+    if (CHIMA_KeyCacheLookup(key, roundKeys32) == 0)
+        return;
+
+    Expand_Round_Keys(key, roundKeys32);
+    CHIMA_KeyCacheInsert(key, roundKeys32);
+}
+
+/**
+ * @brief Inicializa o contexto expandindo a chave uma única vez.
+ *
+ * @param pCtx          Contexto de saída
+ * @param key           Chave de 128 bits
+ * @param xSize         Tamanho do bloco
+ * @param ui32NumRounds Número de rodadas (9 a 22)
+ * @return 0 em caso de sucesso, -1 se o número de rodadas for inválido
+ */
+int CHIMA_CtxInit(CHIMA_Ctx *pCtx, const uint8_t *key, BlockCipherSize xSize, uint32_t ui32NumRounds) {
+    if (ui32NumRounds < CHIMA_MIN_ROUNDS || ui32NumRounds > CHIMA_MAX_ROUNDS)
+        return -1;
+
+    Expand_Round_Keys(key, pCtx->aui32RoundKeys);
+    pCtx->xSize = xSize;
+    pCtx->ui32NumRounds = ui32NumRounds;
+    pCtx->xTableMode = CHIMA_TABLES_NONE;
+    pCtx->pui64Tables = NULL;
+    pCtx->szTablesSize = 0;
+    return 0;
+}
+
+/**
+ * @brief Libera as tabelas do contexto, apagando seu conteúdo.
+ *
+ * @param pCtx Contexto
+ */
+static void Free_Tables(CHIMA_Ctx *pCtx) {
+    if (pCtx->pui64Tables != NULL) {
+        SecureZero(pCtx->pui64Tables, pCtx->szTablesSize);
+        free(pCtx->pui64Tables);
+    }
+    pCtx->xTableMode = CHIMA_TABLES_NONE;
+    pCtx->pui64Tables = NULL;
+    pCtx->szTablesSize = 0;
+}
+
+/**
+ * @brief Compila a permutação de uma rodada para um byte da entrada.
+ *
+ * A permutação é linear sobre os bits, então a entrada de valor v é o OU
+ * das entradas de cada bit de v; só os 8 bits isolados do byte passam por
+ * PermuteWithMask.
+ *
+ * @param row       Tabela de saída (256 entradas)
+ * @param mask      Máscara de permutação da rodada
+ * @param byte      Posição do byte na metade do bloco
+ * @param num_bytes Bytes da metade do bloco
+ */
+static void Build_Perm_Row(uint64_t *row, uint64_t mask, int byte, int num_bytes) {
+    row[0] = 0;
+    for (uint32_t bit = 0; bit < 8; bit++)
+        row[1u << bit] = PermuteWithMask(1ULL << (8 * byte + bit), mask, num_bytes * 8);
+    for (uint32_t v = 3; v < 256; v++)
+        if (v & (v - 1))
+            row[v] = row[v & (v - 1)] | row[v & -v];
+}
+
+/**
+ * @brief Gera as tabelas de cada rodada.
+ *
+ * CHIMA_TABLES_PERM guarda só a permutação. CHIMA_TABLES_TTABLE compõe
+ * também a adição da chave e a S-Box: a entrada v do byte b vale
+ * P(S(v ^ k_b) << 8b), já que S age byte a byte e P é linear.
+ *
+ * @param pCtx       Contexto com as chaves expandidas
+ * @param xTableMode Tipo de tabela
+ * @param table      Tabelas de saída (rodadas x bytes x 256)
+ */
+static void Build_Tables(const CHIMA_Ctx *pCtx, CHIMA_TableMode xTableMode, uint64_t *table) {
+    int num_bytes = (pCtx->xSize == BLOCK_MODE_64) ? 4 : 8;
+    const uint32_t *roundKeys = pCtx->aui32RoundKeys;
+    uint64_t mask, key, perm[256];
+    uint8_t kb;
+
+    for (uint32_t i = 0; i < pCtx->ui32NumRounds; i++) {
+        if (pCtx->xSize == BLOCK_MODE_64) {
+            key  = roundKeys[2 * i];
+            mask = roundKeys[2 * i + 1];
+        } else {
+            key  = ((uint64_t)roundKeys[2 * i] << 32) | roundKeys[2 * i + 1];
+            mask = key;
+        }
+
+        for (int b = 0; b < num_bytes; b++, table += 256) {
+            if (xTableMode == CHIMA_TABLES_PERM) {
+                Build_Perm_Row(table, mask, b, num_bytes);
+                continue;
+            }
+            Build_Perm_Row(perm, mask, b, num_bytes);
+            kb = (uint8_t)(key >> (8 * b));
+            for (uint32_t v = 0; v < 256; v++)
+                table[v] = perm[g_AesSBox[v ^ kb]];
+        }
+    }
+    SecureZero(perm, sizeof(perm));
+}
+
+/**
+ * @brief Pré-calcula as tabelas por rodada do contexto.
+ *
+ * @param pCtx       Contexto inicializado
+ * @param xTableMode Tipo de tabela desejada
+ * @return Tamanho das tabelas em bytes (0 se nenhuma ou em falha de alocação)
+ */
+size_t CHIMA_CtxSetTables(CHIMA_Ctx *pCtx, CHIMA_TableMode xTableMode) {
+    int num_bytes = (pCtx->xSize == BLOCK_MODE_64) ? 4 : 8;
+    size_t size = (size_t)pCtx->ui32NumRounds * num_bytes * 256 * sizeof(uint64_t);
+    uint64_t *table;
+
+    Free_Tables(pCtx);
+    if (xTableMode == CHIMA_TABLES_NONE)
+        return 0;
+
+    table = (uint64_t *)malloc(size);
+    if (table == NULL)
+        return 0;
+
+    switch (xTableMode) {
+        case CHIMA_TABLES_PERM:
+        case CHIMA_TABLES_TTABLE: Build_Tables(pCtx, xTableMode, table); break;
+        default: free(table); return 0;
+    }
+
+    pCtx->pui64Tables = table;
+    pCtx->szTablesSize = size;
+    pCtx->xTableMode = xTableMode;
+    return size;
+}
+
+/**
+ * @brief Informa a memória ocupada pelas tabelas do contexto.
+ *
+ * @param pCtx Contexto
+ * @return Tamanho em bytes (0 sem tabelas)
+ */
+size_t CHIMA_CtxTablesSize(const CHIMA_Ctx *pCtx) {
+    return pCtx->szTablesSize;
+}
+
+/**
+ * @brief Apaga as chaves do contexto e libera as tabelas.
+ *
+ * @param pCtx Contexto
+ */
+void CHIMA_CtxFree(CHIMA_Ctx *pCtx) {
+    Free_Tables(pCtx);
+    SecureZero(pCtx->aui32RoundKeys, sizeof(pCtx->aui32RoundKeys));
+}
+
+/**
+ * @brief Prepara um contexto temporário com a chave vinda do cache.
+ *
+ * @param pCtx          Contexto de saída
+ * @param key           Chave de 128 bits
+ * @param mode          Tamanho do bloco
+ * @param ui32NumRounds Número de rodadas já validado
+ */
+static void Cached_Ctx(CHIMA_Ctx *pCtx, const uint8_t *key, BlockCipherSize mode, uint32_t ui32NumRounds) {
+    Expand_Round_Keys_Cached(key, pCtx->aui32RoundKeys);
+    pCtx->xSize = mode;
+    pCtx->ui32NumRounds = ui32NumRounds;
+    pCtx->xTableMode = CHIMA_TABLES_NONE;
+    pCtx->pui64Tables = NULL;
+    pCtx->szTablesSize = 0;
+}
+
+/**
+ * @brief Prepara um contexto temporário para as funções sem contexto.
+ *
+ * Usa o número de rodadas configurado por CHIMA_setNumberOfRounds, lido
+ * uma única vez para que todo o bloco use o mesmo valor.
+ *
+ * @param pCtx Contexto de saída
+ * @param key  Chave de 128 bits
+ * @param mode Tamanho do bloco
+ */
+static void Legacy_Ctx(CHIMA_Ctx *pCtx, const uint8_t *key, BlockCipherSize mode) {
+    Cached_Ctx(pCtx, key, mode, atomic_load_explicit(&g_num_rodadas_feistel, memory_order_relaxed));
+}
+
+/**
+ * @brief Interface genérica para cifrar blocos
+ * 
+ * @param pt 
+ * @param key 
+ * @param iv 
+ * @param ct 
+ * @param xSize 
+ * @param xMode
+ * @param ui32NumRounds 
+ */
+void CHIMA_Cipher(const uint8_t *plaintext, const uint8_t *key, const uint8_t *iv,
+     uint8_t *ciphertext, BlockCipherSize xSize, CipherMode xMode, uint32_t ui32NumRounds) {
+
+    // O número de rodadas fica no contexto local; o estado global não é alterado
+    CHIMA_Ctx xCtx;
+    if (ui32NumRounds < CHIMA_MIN_ROUNDS || ui32NumRounds > CHIMA_MAX_ROUNDS) {
+        PRINT_Write("Número de rodadas inválido. Usando última configuração.\n", 53);
+        Legacy_Ctx(&xCtx, key, xSize);
+    } else {
+        Cached_Ctx(&xCtx, key, xSize, ui32NumRounds);
+    }
+
+    CHIMA_Cipher_Ctx(&xCtx, plaintext, iv, ciphertext, xMode);
+}
+
+/**
+ * @brief Interface genérica para decifrar blocos
+ * 
+ * @param ct 
+ * @param key 
+ * @param iv 
+ * @param pt 
+ * @param xSize 
+ * @param xMode
+ * @param ui32NumRounds
+ */
+void CHIMA_Decipher(const uint8_t *ciphertext, const uint8_t *key, const uint8_t *iv,
+     uint8_t *decrypted, BlockCipherSize xSize, CipherMode xMode, uint32_t ui32NumRounds) {
+
+    // O número de rodadas fica no contexto local; o estado global não é alterado
+    CHIMA_Ctx xCtx;
+    if (ui32NumRounds < CHIMA_MIN_ROUNDS || ui32NumRounds > CHIMA_MAX_ROUNDS) {
+        PRINT_Write("Número de rodadas inválido. Usando última configuração.\n", 53);
+        Legacy_Ctx(&xCtx, key, xSize);
+    } else {
+        Cached_Ctx(&xCtx, key, xSize, ui32NumRounds);
+    }
+
+    CHIMA_Decipher_Ctx(&xCtx, ciphertext, iv, decrypted, xMode);
+}
+
+/**
+ * @brief Interface genérica para cifrar blocos com contexto
+ *
+ * @param pCtx       Contexto inicializado por CHIMA_CtxInit
+ * @param plaintext  Bloco claro
+ * @param iv         Vetor de inicialização (ignorado em ECB)
+ * @param ciphertext Bloco cifrado
+ * @param xMode      Modo de operação
+ */
+void CHIMA_Cipher_Ctx(const CHIMA_Ctx *pCtx, const uint8_t *plaintext, const uint8_t *iv,
+     uint8_t *ciphertext, CipherMode xMode) {
+
+    switch (xMode) {
+        case CIPHER_MODE_ECB: CHIMA_EncryptECB_Ctx(pCtx, plaintext,     ciphertext); break;
+        case CIPHER_MODE_CBC: CHIMA_EncryptCBC_Ctx(pCtx, plaintext, iv, ciphertext); break;
+        case CIPHER_MODE_CFB: CHIMA_EncryptCFB_Ctx(pCtx, plaintext, iv, ciphertext); break;
+        case CIPHER_MODE_OFB: CHIMA_EncryptOFB_Ctx(pCtx, plaintext, iv, ciphertext); break;
+        case CIPHER_MODE_CTR: CHIMA_EncryptCTR_Ctx(pCtx, plaintext, iv, ciphertext); break;
+    }
+}
+
+/**
+ * @brief Interface genérica para decifrar blocos com contexto
+ *
+ * @param pCtx       Contexto inicializado por CHIMA_CtxInit
+ * @param ciphertext Bloco cifrado
+ * @param iv         Vetor de inicialização (ignorado em ECB)
+ * @param decrypted  Bloco decifrado
+ * @param xMode      Modo de operação
+ */
+void CHIMA_Decipher_Ctx(const CHIMA_Ctx *pCtx, const uint8_t *ciphertext, const uint8_t *iv,
+     uint8_t *decrypted, CipherMode xMode) {
+
+    switch (xMode) {
+        case CIPHER_MODE_ECB: CHIMA_DecryptECB_Ctx(pCtx, ciphertext,     decrypted); break;
+        case CIPHER_MODE_CBC: CHIMA_DecryptCBC_Ctx(pCtx, ciphertext, iv, decrypted); break;
+        case CIPHER_MODE_CFB: CHIMA_DecryptCFB_Ctx(pCtx, ciphertext, iv, decrypted); break;
+        case CIPHER_MODE_OFB: CHIMA_DecryptOFB_Ctx(pCtx, ciphertext, iv, decrypted); break;
+        case CIPHER_MODE_CTR: CHIMA_DecryptCTR_Ctx(pCtx, ciphertext, iv, decrypted); break;
+    }
+}
+
+
+// MODO DE CIFRA //
+
+/**
+ * @brief Cifra um único bloco.
+ *
+ * @param pCtx   Contexto com as chaves expandidas
+ * @param input  Dados de entrada
+ * @param output Buffer de saída
+ */
+static void Block_Encrypt(const CHIMA_Ctx *pCtx, const uint8_t *input, uint8_t *output) {
+    uint32_t block[4] = {0};
+    BlockFromBytes(input, block, pCtx->xSize);
+    Feistel_Encrypt_Ctx(pCtx, block);
+    BlockToBytes(block, output, pCtx->xSize);
+}
+
+/**
+ * @brief Decifra um único bloco.
+ *
+ * @param pCtx   Contexto com as chaves expandidas
+ * @param input  Dados cifrados
+ * @param output Buffer de saída
+ */
+static void Block_Decrypt(const CHIMA_Ctx *pCtx, const uint8_t *input, uint8_t *output) {
+    uint32_t block[4] = {0};
+    BlockFromBytes(input, block, pCtx->xSize);
+    Feistel_Decrypt_Ctx(pCtx, block);
+    BlockToBytes(block, output, pCtx->xSize);
+}
+
+/**
+ * @brief Copia bytes para um buffer auxiliar.
+ *
+ * @param src Fonte
+ * @param dst Destino
+ * @param len Quantidade de bytes
+ */
+static inline void Load_Block(const uint8_t *src, uint8_t *dst, uint32_t len) {
+    memcpy(dst, src, len);
+}
+
+/**
+ * @brief Função de rodada aplicada a uma metade, conforme o contexto.
+ *
+ * @param pCtx      Contexto
+ * @param pDispatch Primitivas escolhidas para o processador
+ * @param round     Índice da rodada
+ * @param x         Metade de entrada
+ * @return Valor a ser somado à outra metade
+ */
+static inline uint64_t Round_Function(const CHIMA_Ctx *pCtx, const CHIMA_Dispatch *pDispatch, uint32_t round, uint64_t x) {
+    const uint32_t *rk = pCtx->aui32RoundKeys;
+    uint64_t K;
+
+    if (pCtx->xSize == BLOCK_MODE_64) {
+        switch (pCtx->xTableMode) {
+            case CHIMA_TABLES_TTABLE:
+                return Table_Lookup(pCtx->pui64Tables + (size_t)round * 4 * 256, x, 4);
+            case CHIMA_TABLES_PERM:
+                return Table_Lookup(pCtx->pui64Tables + (size_t)round * 4 * 256,
+                                    pDispatch->pfnApplySBox(x ^ rk[2 * round], 4), 4);
+            default:
+                return pDispatch->pfnPermute(pDispatch->pfnApplySBox(x ^ rk[2 * round], 4), rk[2 * round + 1], 32);
+        }
+    }
+
+    K = ((uint64_t)rk[2 * round] << 32) | rk[2 * round + 1];
+    switch (pCtx->xTableMode) {
+        case CHIMA_TABLES_TTABLE:
+            return Table_Lookup(pCtx->pui64Tables + (size_t)round * 8 * 256, x, 8);
+        case CHIMA_TABLES_PERM:
+            return Table_Lookup(pCtx->pui64Tables + (size_t)round * 8 * 256, pDispatch->pfnApplySBox(x ^ K, 8), 8);
+        default:
+            return pDispatch->pfnPermute(pDispatch->pfnApplySBox(x ^ K, 8), K, 64);
+    }
+}
+
+/**
+ * @brief Cifra ou decifra um grupo de blocos com as rodadas intercaladas.
+ *
+ * Uma rodada é uma cadeia serial (S-Box, permutação, XOR); processar
+ * INTERLEAVE_BLOCKS blocos independentes lado a lado dá ao processador
+ * trabalho para as unidades ociosas sem exigir instruções vetoriais. Cada
+ * bloco usa o seu contexto; todos têm o mesmo xSize e ui32NumRounds.
+ *
+ * @param apCtx   Contexto de cada bloco
+ * @param input   INTERLEAVE_BLOCKS blocos de entrada
+ * @param output  Blocos de saída (pode ser igual a input)
+ * @param decrypt 0 para cifrar, 1 para decifrar
+ */
+static void Interleaved_Group(const CHIMA_Ctx *const *apCtx, const uint8_t *input, uint8_t *output, int decrypt) {
+    BlockCipherSize xSize = apCtx[0]->xSize;
+    uint32_t bs = (xSize == BLOCK_MODE_64) ? 8 : 16;
+    uint32_t rounds = apCtx[0]->ui32NumRounds, block[4], r;
+    uint64_t aL[INTERLEAVE_BLOCKS], aR[INTERLEAVE_BLOCKS], aF[INTERLEAVE_BLOCKS], half[2];
+    const CHIMA_Dispatch *pDispatch = CHIMA_GetDispatch();
+
+    for (int j = 0; j < INTERLEAVE_BLOCKS; j++) {
+        BlockFromBytes(input + j * bs, block, xSize);
+        if (xSize == BLOCK_MODE_64) {
+            half[0] = block[0];
+            half[1] = block[1];
+        } else {
+            half[0] = ((uint64_t)block[0] << 32) | block[1];
+            half[1] = ((uint64_t)block[2] << 32) | block[3];
+        }
+        aL[j] = half[decrypt];
+        aR[j] = half[!decrypt];
+    }
+
+    for (uint32_t k = 0; k < rounds; k++) {
+        r = decrypt ? rounds - 1 - k : k;
+        for (int j = 0; j < INTERLEAVE_BLOCKS; j++)
+            aF[j] = Round_Function(apCtx[j], pDispatch, r, aR[j]);
+        for (int j = 0; j < INTERLEAVE_BLOCKS; j++) {
+            aF[j] ^= aL[j];
+            aL[j] = aR[j];
+            aR[j] = aF[j];
+        }
+    }
+
+    for (int j = 0; j < INTERLEAVE_BLOCKS; j++) {
+        half[decrypt]  = aL[j];
+        half[!decrypt] = aR[j];
+        if (xSize == BLOCK_MODE_64) {
+            block[0] = (uint32_t)half[0];
+            block[1] = (uint32_t)half[1];
+        } else {
+            block[0] = (uint32_t)(half[0] >> 32); block[1] = (uint32_t)half[0];
+            block[2] = (uint32_t)(half[1] >> 32); block[3] = (uint32_t)half[1];
+        }
+        BlockToBytes(block, output + j * bs, xSize);
+    }
+}
+
+/**
+ * @brief Cifra ou decifra grupos de blocos com as rodadas intercaladas.
+ *
+ * @param pCtx    Contexto
+ * @param input   Blocos de entrada
+ * @param output  Blocos de saída (pode ser igual a input)
+ * @param n       Quantidade de blocos
+ * @param decrypt 0 para cifrar, 1 para decifrar
+ * @return Quantidade de blocos processados
+ */
+static size_t Blocks_Interleaved(const CHIMA_Ctx *pCtx, const uint8_t *input, uint8_t *output, size_t n, int decrypt) {
+	uint32_t bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    size_t groups = n / INTERLEAVE_BLOCKS;
+    const CHIMA_Ctx *apCtx[INTERLEAVE_BLOCKS];
+
+    for (int j = 0; j < INTERLEAVE_BLOCKS; j++)
+        apCtx[j] = pCtx;
+    for (size_t g = 0; g < groups; g++)
+        Interleaved_Group(apCtx, input + g * INTERLEAVE_BLOCKS * bs, output + g * INTERLEAVE_BLOCKS * bs, decrypt);
+    return groups * INTERLEAVE_BLOCKS;
+}
+
+/**
+ * @brief Cifra n blocos consecutivos de forma independente.
+ *
+ * @param pCtx   Contexto com as chaves expandidas
+ * @param input  Blocos de entrada
+ * @param output Blocos de saída (pode ser igual a input)
+ * @param n      Quantidade de blocos
+ */
+static void Blocks_Encrypt(const CHIMA_Ctx *pCtx, const uint8_t *input, uint8_t *output, size_t n) {
+	uint32_t bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    const CHIMA_BlocksFn *ppfnKernel = CHIMA_GetDispatch()->apfnEncryptBlocks;
+    size_t i = 0;
+
+    for (; *ppfnKernel != NULL && i < n; ppfnKernel++)
+        i += (*ppfnKernel)(pCtx, input + i * bs, output + i * bs, n - i);
+    i += Blocks_Interleaved(pCtx, input + i * bs, output + i * bs, n - i, 0);
+    for (; i < n; i++)
+        Block_Encrypt(pCtx, input + i * bs, output + i * bs);
+}
+
+/**
+ * @brief Decifra n blocos consecutivos de forma independente.
+ *
+ * @param pCtx   Contexto com as chaves expandidas
+ * @param input  Blocos cifrados
+ * @param output Blocos de saída (pode ser igual a input)
+ * @param n      Quantidade de blocos
+ */
+static void Blocks_Decrypt(const CHIMA_Ctx *pCtx, const uint8_t *input, uint8_t *output, size_t n) {
+	uint32_t bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    const CHIMA_BlocksFn *ppfnKernel = CHIMA_GetDispatch()->apfnDecryptBlocks;
+    size_t i = 0;
+
+    for (; *ppfnKernel != NULL && i < n; ppfnKernel++)
+        i += (*ppfnKernel)(pCtx, input + i * bs, output + i * bs, n - i);
+    i += Blocks_Interleaved(pCtx, input + i * bs, output + i * bs, n - i, 1);
+    for (; i < n; i++)
+        Block_Decrypt(pCtx, input + i * bs, output + i * bs);
+}
+
+/**
+ * @brief Cifra ou decifra n blocos, cada um com o seu contexto.
+ *
+ * Os contextos têm o mesmo xSize e ui32NumRounds. O núcleo com várias
+ * chaves, quando existe, trata os grupos completos; o restante passa pelas
+ * rodadas intercaladas e pelo caminho escalar.
+ *
+ * @param apCtx   Contexto de cada bloco
+ * @param input   Blocos de entrada
+ * @param output  Blocos de saída (pode ser igual a input)
+ * @param n       Quantidade de blocos
+ * @param decrypt 0 para cifrar, 1 para decifrar
+ */
+static void Blocks_MultiKey(const CHIMA_Ctx *const *apCtx, const uint8_t *input, uint8_t *output, size_t n, int decrypt) {
+    const CHIMA_Dispatch *pDispatch = CHIMA_GetDispatch();
+    CHIMA_MultiKeyFn pfnKernel = decrypt ? pDispatch->pfnDecryptMultiKey : pDispatch->pfnEncryptMultiKey;
+    uint32_t bs;
+    size_t i = 0;
+
+    if (n == 0)
+        return;
+    bs = (apCtx[0]->xSize == BLOCK_MODE_64) ? 8 : 16;
+
+    if (pfnKernel != NULL)
+        i = pfnKernel(apCtx, input, output, n);
+    for (; i + INTERLEAVE_BLOCKS <= n; i += INTERLEAVE_BLOCKS)
+        Interleaved_Group(apCtx + i, input + i * bs, output + i * bs, decrypt);
+    for (; i < n; i++) {
+        if (decrypt)
+            Block_Decrypt(apCtx[i], input + i * bs, output + i * bs);
+        else
+            Block_Encrypt(apCtx[i], input + i * bs, output + i * bs);
+    }
+}
+
+/**
+ * @brief Incrementa o contador do modo CTR (inteiro big-endian).
+ *
+ * @param counter Contador
+ * @param len     Tamanho do contador em bytes
+ */
+static void Counter_Increment(uint8_t *counter, uint32_t len) {
+    for (int32_t i = (int32_t)len - 1; i >= 0; i--)
+        if (++counter[i] != 0)
+            break;
+}
+
+// OPERATION MODES //
+
+/**
+ * @brief Modo ECB - Encrypt
+ *
+ * @param plaintext
+ * @param key
+ * @param ciphertext
+ * @param mode
+ */
+void CHIMA_EncryptECB(const uint8_t *plaintext, const uint8_t *key, uint8_t *ciphertext, BlockCipherSize mode) {
+    CHIMA_Ctx xCtx;
+    Legacy_Ctx(&xCtx, key, mode);
+    CHIMA_EncryptECB_Ctx(&xCtx, plaintext, ciphertext);
+}
+
+/**
+ * @brief Modo ECB - Decrypt
+ *
+ * @param ciphertext
+ * @param key
+ * @param plaintext
+ * @param mode
+ */
+void CHIMA_DecryptECB(const uint8_t *ciphertext, const uint8_t *key, uint8_t *plaintext, BlockCipherSize mode) {
+    CHIMA_Ctx xCtx;
+    Legacy_Ctx(&xCtx, key, mode);
+    CHIMA_DecryptECB_Ctx(&xCtx, ciphertext, plaintext);
+}
+
+/**
+ * @brief Modo CBC - Encrypt
+ *
+ * @param pt
+ * @param key
+ * @param iv
+ * @param ct
+ * @param mode
+ */
+void CHIMA_EncryptCBC(const uint8_t *pt, const uint8_t *key, const uint8_t *iv, uint8_t *ct, BlockCipherSize mode) {
+    CHIMA_Ctx xCtx;
+    Legacy_Ctx(&xCtx, key, mode);
+    CHIMA_EncryptCBC_Ctx(&xCtx, pt, iv, ct);
+}
+
+/**
+ * @brief Modo CBC - Decrypt
+ *
+ * @param ct
+ * @param key
+ * @param iv
+ * @param pt
+ * @param mode
+ */
+void CHIMA_DecryptCBC(const uint8_t *ct, const uint8_t *key, const uint8_t *iv, uint8_t *pt, BlockCipherSize mode) {
+    CHIMA_Ctx xCtx;
+    Legacy_Ctx(&xCtx, key, mode);
+    CHIMA_DecryptCBC_Ctx(&xCtx, ct, iv, pt);
+}
+
+/**
+ * @brief Modo CFB - Encrypt
+ *
+ * @param pt
+ * @param key
+ * @param iv
+ * @param ct
+ * @param mode
+ */
+void CHIMA_EncryptCFB(const uint8_t *pt, const uint8_t *key, const uint8_t *iv, uint8_t *ct, BlockCipherSize mode) {
+    CHIMA_Ctx xCtx;
+    Legacy_Ctx(&xCtx, key, mode);
+    CHIMA_EncryptCFB_Ctx(&xCtx, pt, iv, ct);
+}
+
+/**
+ * @brief Modo CFB - Decrypt
+ *
+ * @param ct
+ * @param key
+ * @param iv
+ * @param pt
+ * @param mode
+ */
+void CHIMA_DecryptCFB(const uint8_t *ct, const uint8_t *key, const uint8_t *iv, uint8_t *pt, BlockCipherSize mode) {
+    CHIMA_EncryptCFB(ct, key, iv, pt, mode);
+}
+
+/**
+ * @brief Modo OFB - Encrypt
+ *
+ * @param pt
+ * @param key
+ * @param iv
+ * @param ct
+ * @param mode
+ */
+void CHIMA_EncryptOFB(const uint8_t *pt, const uint8_t *key, const uint8_t *iv, uint8_t *ct, BlockCipherSize mode) {
+    CHIMA_Ctx xCtx;
+    Legacy_Ctx(&xCtx, key, mode);
+    CHIMA_EncryptOFB_Ctx(&xCtx, pt, iv, ct);
+}
+
+/**
+ * @brief Modo OFB - Decrypt
+ *
+ * @param ct
+ * @param key
+ * @param iv
+ * @param pt
+ * @param mode
+ */
+void CHIMA_DecryptOFB(const uint8_t *ct, const uint8_t *key, const uint8_t *iv, uint8_t *pt, BlockCipherSize mode) {
+    CHIMA_EncryptOFB(ct, key, iv, pt, mode);
+}
+
+/**
+ * @brief Modo CTR - Encrypt
+ *
+ * @param pt
+ * @param key
+ * @param iv
+ * @param ct
+ * @param mode
+ */
+void CHIMA_EncryptCTR(const uint8_t *pt, const uint8_t *key, const uint8_t *iv, uint8_t *ct, BlockCipherSize mode) {
+    CHIMA_Ctx xCtx;
+    Legacy_Ctx(&xCtx, key, mode);
+    CHIMA_EncryptCTR_Ctx(&xCtx, pt, iv, ct);
+}
+
+/**
+ * @brief Modo CTR - Decrypt
+ *
+ * @param ct
+ * @param key
+ * @param iv
+ * @param pt
+ * @param mode
+ */
+void CHIMA_DecryptCTR(const uint8_t *ct, const uint8_t *key, const uint8_t *iv, uint8_t *pt, BlockCipherSize mode) {
+    CHIMA_EncryptCTR(ct, key, iv, pt, mode);
+}
+
+
+// OPERATION MODES COM CONTEXTO //
+
+/**
+ * @brief Modo ECB - Encrypt com contexto
+ *
+ * @param pCtx
+ * @param plaintext
+ * @param ciphertext
+ */
+void CHIMA_EncryptECB_Ctx(const CHIMA_Ctx *pCtx, const uint8_t *plaintext, uint8_t *ciphertext) {
+    Block_Encrypt(pCtx, plaintext, ciphertext);
+}
+
+/**
+ * @brief Modo ECB - Decrypt com contexto
+ *
+ * @param pCtx
+ * @param ciphertext
+ * @param plaintext
+ */
+void CHIMA_DecryptECB_Ctx(const CHIMA_Ctx *pCtx, const uint8_t *ciphertext, uint8_t *plaintext) {
+    Block_Decrypt(pCtx, ciphertext, plaintext);
+}
+
+/**
+ * @brief Modo CBC - Encrypt com contexto
+ *
+ * @param pCtx
+ * @param pt
+ * @param iv
+ * @param ct
+ */
+void CHIMA_EncryptCBC_Ctx(const CHIMA_Ctx *pCtx, const uint8_t *pt, const uint8_t *iv, uint8_t *ct) {
+	uint32_t bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    uint8_t iv_local[16] = {0}, xor_buf[16] = {0};
+
+    Load_Block(iv, iv_local, bs);
+    XOR_Blocks(xor_buf, pt, iv_local, bs);
+    Block_Encrypt(pCtx, xor_buf, ct);
+}
+
+/**
+ * @brief Modo CBC - Decrypt com contexto
+ *
+ * @param pCtx
+ * @param ct
+ * @param iv
+ * @param pt
+ */
+void CHIMA_DecryptCBC_Ctx(const CHIMA_Ctx *pCtx, const uint8_t *ct, const uint8_t *iv, uint8_t *pt) {
+	uint32_t bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    uint8_t iv_local[16] = {0}, temp[16] = {0};
+
+    Load_Block(iv, iv_local, bs);
+    Block_Decrypt(pCtx, ct, temp);
+    XOR_Blocks(pt, temp, iv_local, bs);
+}
+
+/**
+ * @brief Modo CFB - Encrypt com contexto
+ *
+ * @param pCtx
+ * @param pt
+ * @param iv
+ * @param ct
+ */
+void CHIMA_EncryptCFB_Ctx(const CHIMA_Ctx *pCtx, const uint8_t *pt, const uint8_t *iv, uint8_t *ct) {
+	uint32_t bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    uint8_t feedback[16] = {0}, stream[16] = {0};
+
+    Load_Block(iv, feedback, bs);
+    Block_Encrypt(pCtx, feedback, stream);
+    XOR_Blocks(ct, pt, stream, bs);
+}
+
+/**
+ * @brief Modo CFB - Decrypt com contexto
+ *
+ * @param pCtx
  * @param ct
- * @param mode
+ * @param iv
+ * @param pt
  */
-void CHIMA_EncryptCTR(const uint8_t *pt, const uint8_t *key, const uint8_t *iv, uint8_t *ct, BlockCipherSize mode) {
-	uint32_t bs = (mode == BLOCK_MODE_64) ? 8 : 16;
+void CHIMA_DecryptCFB_Ctx(const CHIMA_Ctx *pCtx, const uint8_t *ct, const uint8_t *iv, uint8_t *pt) {
+    CHIMA_EncryptCFB_Ctx(pCtx, ct, iv, pt);
+}
+
+/**
+ * @brief Modo OFB - Encrypt com contexto
+ *
+ * @param pCtx
+ * @param pt
+ * @param iv
+ * @param ct
+ */
+void CHIMA_EncryptOFB_Ctx(const CHIMA_Ctx *pCtx, const uint8_t *pt, const uint8_t *iv, uint8_t *ct) {
+	uint32_t bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    uint8_t stream[16] = {0}, output_block[16] = {0};
+
+    Load_Block(iv, output_block, bs);
+    Block_Encrypt(pCtx, output_block, stream);
+    XOR_Blocks(ct, pt, stream, bs);
+}
+
+/**
+ * @brief Modo OFB - Decrypt com contexto
+ *
+ * @param pCtx
+ * @param ct
+ * @param iv
+ * @param pt
+ */
+void CHIMA_DecryptOFB_Ctx(const CHIMA_Ctx *pCtx, const uint8_t *ct, const uint8_t *iv, uint8_t *pt) {
+    CHIMA_EncryptOFB_Ctx(pCtx, ct, iv, pt);
+}
+
+/**
+ * @brief Modo CTR - Encrypt com contexto
+ *
+ * @param pCtx
+ * @param pt
+ * @param iv
+ * @param ct
+ */
+void CHIMA_EncryptCTR_Ctx(const CHIMA_Ctx *pCtx, const uint8_t *pt, const uint8_t *iv, uint8_t *ct) {
+	uint32_t bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
     uint8_t counter[16] = {0}, stream[16] = {0};
 
     Load_Block(iv, counter, bs);
-
-    uint32_t rk[44];
-    Expand_Round_Keys(key, rk);
-    Block_Encrypt(counter, rk, stream, mode);
+    Block_Encrypt(pCtx, counter, stream);
     XOR_Blocks(ct, pt, stream, bs);
 }
 
 /**
- * @brief Modo CTR - Decrypt
+ * @brief Modo CTR - Decrypt com contexto
  *
+ * @param pCtx
  * @param ct
- * @param key
  * @param iv
  * @param pt
- * @param mode
  */
-void CHIMA_DecryptCTR(const uint8_t *ct, const uint8_t *key, const uint8_t *iv, uint8_t *pt, BlockCipherSize mode) {
-    CHIMA_EncryptCTR(ct, key, iv, pt, mode);
+void CHIMA_DecryptCTR_Ctx(const CHIMA_Ctx *pCtx, const uint8_t *ct, const uint8_t *iv, uint8_t *pt) {
+    CHIMA_EncryptCTR_Ctx(pCtx, ct, iv, pt);
+}
+
+
+// OPERATION MODES EM MASSA //
+
+/**
+ * @brief Modo ECB - Encrypt de vários blocos
+ *
+ * @param pCtx
+ * @param in
+ * @param out
+ * @param nblocks
+ */
+void CHIMA_EncryptECB_Buf(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks) {
+    Blocks_Encrypt(pCtx, in, out, nblocks);
+}
+
+/**
+ * @brief Modo ECB - Decrypt de vários blocos
+ *
+ * @param pCtx
+ * @param in
+ * @param out
+ * @param nblocks
+ */
+void CHIMA_DecryptECB_Buf(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks) {
+    Blocks_Decrypt(pCtx, in, out, nblocks);
+}
+
+/**
+ * @brief Modo CBC - Encrypt de vários blocos
+ *
+ * @param pCtx
+ * @param in
+ * @param out
+ * @param nblocks
+ * @param iv      IV de entrada; recebe o último bloco cifrado
+ */
+void CHIMA_EncryptCBC_Buf(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv) {
+	uint32_t bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    uint8_t chain[16] = {0}, xor_buf[16] = {0};
+
+    Load_Block(iv, chain, bs);
+    for (size_t i = 0; i < nblocks; i++, in += bs, out += bs) {
+        XOR_Blocks(xor_buf, in, chain, bs);
+        Block_Encrypt(pCtx, xor_buf, chain);
+        Load_Block(chain, out, bs);
+    }
+    Load_Block(chain, iv, bs);
+}
+
+/**
+ * @brief Modo CBC - Decrypt de vários blocos
+ *
+ * Os blocos são decifrados em lotes independentes e só depois combinados
+ * com o bloco cifrado anterior.
+ *
+ * @param pCtx
+ * @param in
+ * @param out
+ * @param nblocks
+ * @param iv      IV de entrada; recebe o último bloco cifrado
+ */
+void CHIMA_DecryptCBC_Buf(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv) {
+	uint32_t bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    uint8_t chain[16] = {0}, next[16] = {0}, temp[BULK_BLOCKS * 16];
+    size_t n;
+
+    Load_Block(iv, chain, bs);
+    while (nblocks > 0) {
+        n = (nblocks < BULK_BLOCKS) ? nblocks : BULK_BLOCKS;
+        Blocks_Decrypt(pCtx, in, temp, n);
+        Load_Block(in + (n - 1) * bs, next, bs);
+
+        // De trás para frente: out pode ser igual a in
+        for (size_t j = n - 1; j > 0; j--)
+            XOR_Blocks(out + j * bs, temp + j * bs, in + (j - 1) * bs, bs);
+        XOR_Blocks(out, temp, chain, bs);
+
+        Load_Block(next, chain, bs);
+        in += n * bs;
+        out += n * bs;
+        nblocks -= n;
+    }
+    Load_Block(chain, iv, bs);
+}
+
+/**
+ * @brief Obtém a mensagem de índice szIndex de um vetor de entrada.
+ */
+typedef void (*MultiKeyGetFn)(const void *pSrc, size_t szIndex, CHIMA_MultiKeyOp *pOp);
+
+/**
+ * @brief Via do escalonador de várias mensagens: uma mensagem em andamento.
+ */
+typedef struct {
+    CHIMA_MultiKeyOp xOp;       /**< Mensagem */
+    size_t           szPos;     /**< Próximo bloco da mensagem */
+    int              iInverse;  /**< Usa a decifração do bloco (ECB/CBC ao decifrar) */
+    uint32_t         ui32Group; /**< Grupo do contexto da via */
+    uint8_t          chain[16]; /**< Encadeamento: bloco anterior, realimentação ou contador */
+} MultiKeyLane;
+
+/**
+ * @brief Vias em andamento com o mesmo contexto e sentido da rede.
+ */
+typedef struct {
+    const CHIMA_Ctx *pCtx;      /**< Contexto comum */
+    int              iInverse;  /**< Sentido da rede */
+    uint32_t         ui32Lanes; /**< Vias do grupo */
+    uint32_t         ui32Slot;  /**< Posição na tabela de espalhamento */
+    uint32_t         ui32Fill;  /**< Próxima posição do grupo na ordem do passo */
+} MultiKeyGroup;
+
+/**
+ * @brief Estado do escalonador.
+ *
+ * Cada via entra em um grupo quando sua mensagem é admitida, pela tabela
+ * de espalhamento indexada pelo contexto; como o contexto de uma via não
+ * muda, o agrupamento não é refeito a cada passo.
+ */
+typedef struct {
+    MultiKeyLane  aLanes[MULTIKEY_LANES];
+    MultiKeyGroup aGroups[MULTIKEY_LANES];
+    int16_t       ai16Hash[MULTIKEY_HASH];       /**< Grupo de cada posição (-1 se vazia) */
+    uint16_t      aui16Active[MULTIKEY_LANES];   /**< Grupos em uso */
+    uint16_t      aui16Free[MULTIKEY_LANES];     /**< Grupos livres */
+    uint16_t      aui16Order[MULTIKEY_LANES];    /**< Vias do passo ordenadas por grupo */
+    uint8_t       aucBatch[MULTIKEY_LANES * 16]; /**< Blocos do lote */
+    const CHIMA_Ctx *apBatchCtx[MULTIKEY_LANES]; /**< Contexto de cada bloco do lote */
+    size_t        szLanes;                       /**< Vias ocupadas */
+    size_t        szActive;                      /**< Grupos em uso */
+    size_t        szFree;                        /**< Grupos livres */
+} MultiKeySched;
+
+/**
+ * @brief Indica se o modo, nesse sentido, já é paralelo em *_Buf.
+ */
+static int MultiKey_Parallel(CipherMode xMode, int decrypt) {
+    return xMode == CIPHER_MODE_ECB || xMode == CIPHER_MODE_CTR
+        || (decrypt && (xMode == CIPHER_MODE_CBC || xMode == CIPHER_MODE_CFB));
+}
+
+/**
+ * @brief Processa uma mensagem inteira com a função *_Buf do seu modo.
+ */
+static void MultiKey_Direct(const CHIMA_MultiKeyOp *pOp, int decrypt) {
+    switch (pOp->xMode) {
+        case CIPHER_MODE_ECB:
+            if (decrypt)
+                CHIMA_DecryptECB_Buf(pOp->pCtx, pOp->in, pOp->out, pOp->nblocks);
+            else
+                CHIMA_EncryptECB_Buf(pOp->pCtx, pOp->in, pOp->out, pOp->nblocks);
+            break;
+        case CIPHER_MODE_CBC:
+            if (decrypt)
+                CHIMA_DecryptCBC_Buf(pOp->pCtx, pOp->in, pOp->out, pOp->nblocks, pOp->iv);
+            else
+                CHIMA_EncryptCBC_Buf(pOp->pCtx, pOp->in, pOp->out, pOp->nblocks, pOp->iv);
+            break;
+        case CIPHER_MODE_CFB:
+            if (decrypt)
+                CHIMA_DecryptCFB_Buf(pOp->pCtx, pOp->in, pOp->out, pOp->nblocks, pOp->iv);
+            else
+                CHIMA_EncryptCFB_Buf(pOp->pCtx, pOp->in, pOp->out, pOp->nblocks, pOp->iv);
+            break;
+        case CIPHER_MODE_OFB:
+            CHIMA_EncryptOFB_Buf(pOp->pCtx, pOp->in, pOp->out, pOp->nblocks, pOp->iv);
+            break;
+        default:
+            CHIMA_EncryptCTR_Buf(pOp->pCtx, pOp->in, pOp->out, pOp->nblocks, pOp->iv);
+            break;
+    }
+}
+
+/**
+ * @brief Entrada do bloco a cifrar/decifrar no passo corrente da via.
+ */
+static void MultiKey_Input(const CHIMA_MultiKeyOp *pOp, const MultiKeyLane *pLane, uint32_t bs, int decrypt, uint8_t *dst) {
+    const uint8_t *src = pOp->in + pLane->szPos * bs;
+
+    switch (pOp->xMode) {
+        case CIPHER_MODE_ECB:
+            Load_Block(src, dst, bs);
+            break;
+        case CIPHER_MODE_CBC:
+            if (decrypt)
+                Load_Block(src, dst, bs);
+            else
+                XOR_Blocks(dst, src, pLane->chain, bs);
+            break;
+        default:
+            Load_Block(pLane->chain, dst, bs);
+            break;
+    }
+}
+
+/**
+ * @brief Aplica o bloco cifrado/decifrado y à saída e ao encadeamento.
+ */
+static void MultiKey_Output(const CHIMA_MultiKeyOp *pOp, MultiKeyLane *pLane, uint32_t bs, int decrypt, const uint8_t *y) {
+    const uint8_t *src = pOp->in + pLane->szPos * bs;
+    uint8_t *dst = pOp->out + pLane->szPos * bs;
+    uint8_t saved[16];
+
+    switch (pOp->xMode) {
+        case CIPHER_MODE_ECB:
+            Load_Block(y, dst, bs);
+            break;
+        case CIPHER_MODE_CBC:
+            if (decrypt) {
+                Load_Block(src, saved, bs);
+                XOR_Blocks(dst, y, pLane->chain, bs);
+                Load_Block(saved, pLane->chain, bs);
+            } else {
+                Load_Block(y, dst, bs);
+                Load_Block(y, pLane->chain, bs);
+            }
+            break;
+        case CIPHER_MODE_CFB:
+            Load_Block(src, saved, bs);
+            XOR_Blocks(dst, saved, y, bs);
+            Load_Block(decrypt ? saved : dst, pLane->chain, bs);
+            break;
+        case CIPHER_MODE_OFB:
+            XOR_Blocks(dst, src, y, bs);
+            Load_Block(y, pLane->chain, bs);
+            break;
+        default:
+            XOR_Blocks(dst, src, y, bs);
+            Counter_Increment(pLane->chain, bs);
+            break;
+    }
+    pLane->szPos++;
+}
+
+/**
+ * @brief Posição inicial de um contexto na tabela de espalhamento.
+ */
+static uint32_t Group_Home(const CHIMA_Ctx *pCtx, int iInverse) {
+    uint64_t x = (uint64_t)(uintptr_t)pCtx ^ (uint64_t)iInverse;
+
+    x *= 0x9E3779B97F4A7C15ULL;
+    return (uint32_t)(x >> 40) & (MULTIKEY_HASH - 1);
+}
+
+/**
+ * @brief Procura o grupo de um contexto.
+ *
+ * @param pSlot Recebe a posição do grupo ou a posição livre onde entraria
+ * @return Índice do grupo, -1 se não existir
+ */
+static int Group_Find(const MultiKeySched *pSched, const CHIMA_Ctx *pCtx, int iInverse, uint32_t *pSlot) {
+    uint32_t slot = Group_Home(pCtx, iInverse);
+    const MultiKeyGroup *pGroup;
+
+    for (; pSched->ai16Hash[slot] >= 0; slot = (slot + 1) & (MULTIKEY_HASH - 1)) {
+        pGroup = &pSched->aGroups[pSched->ai16Hash[slot]];
+        if (pGroup->pCtx == pCtx && pGroup->iInverse == iInverse)
+            break;
+    }
+    *pSlot = slot;
+    return pSched->ai16Hash[slot];
+}
+
+/**
+ * @brief Procura o grupo de um contexto, criando-o se não existir.
+ *
+ * @return Índice do grupo
+ */
+static uint32_t Group_Acquire(MultiKeySched *pSched, const CHIMA_Ctx *pCtx, int iInverse) {
+    uint32_t slot, g;
+    int iFound = Group_Find(pSched, pCtx, iInverse, &slot);
+    MultiKeyGroup *pGroup;
+
+    if (iFound >= 0)
+        return (uint32_t)iFound;
+
+    g = pSched->aui16Free[--pSched->szFree];
+    pGroup = &pSched->aGroups[g];
+    pGroup->pCtx = pCtx;
+    pGroup->iInverse = iInverse;
+    pGroup->ui32Lanes = 0;
+    pGroup->ui32Slot = slot;
+    pSched->ai16Hash[slot] = (int16_t)g;
+    pSched->aui16Active[pSched->szActive++] = (uint16_t)g;
+    return g;
+}
+
+/**
+ * @brief Devolve um grupo sem vias.
+ *
+ * Retira-o da tabela deslocando para trás os seguintes da mesma sequência
+ * (sondagem linear sem marcas de remoção).
+ */
+static void Group_Release(MultiKeySched *pSched, uint32_t g) {
+    uint32_t hole = pSched->aGroups[g].ui32Slot, slot = hole, home;
+    int16_t i16Next;
+
+    for (;;) {
+        slot = (slot + 1) & (MULTIKEY_HASH - 1);
+        i16Next = pSched->ai16Hash[slot];
+        if (i16Next < 0)
+            break;
+        home = Group_Home(pSched->aGroups[i16Next].pCtx, pSched->aGroups[i16Next].iInverse);
+        // Fica onde está se a posição inicial estiver entre o buraco e ela
+        if (((slot - home) & (MULTIKEY_HASH - 1)) < ((slot - hole) & (MULTIKEY_HASH - 1)))
+            continue;
+        pSched->ai16Hash[hole] = i16Next;
+        pSched->aGroups[i16Next].ui32Slot = hole;
+        hole = slot;
+    }
+    pSched->ai16Hash[hole] = -1;
+
+    for (size_t a = 0; a < pSched->szActive; a++) {
+        if (pSched->aui16Active[a] == g) {
+            pSched->aui16Active[a] = pSched->aui16Active[--pSched->szActive];
+            break;
+        }
+    }
+    pSched->aui16Free[pSched->szFree++] = (uint16_t)g;
+}
+
+/**
+ * @brief Cifra os blocos do passo de n vias e aplica os resultados.
+ *
+ * @param pSched     Escalonador
+ * @param pui16Lanes Vias do lote, na ordem dos blocos
+ * @param n          Quantidade de vias
+ * @param pCtx       Contexto comum, ou NULL para um contexto por bloco
+ * @param decrypt    0 para cifrar, 1 para decifrar
+ */
+static void Step_Batch(MultiKeySched *pSched, const uint16_t *pui16Lanes, size_t n, const CHIMA_Ctx *pCtx, int decrypt) {
+    MultiKeyLane *pLane = &pSched->aLanes[pui16Lanes[0]];
+    uint32_t bs = (pLane->xOp.pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    int iInverse = pLane->iInverse;
+
+    for (size_t j = 0; j < n; j++) {
+        pLane = &pSched->aLanes[pui16Lanes[j]];
+        MultiKey_Input(&pLane->xOp, pLane, bs, decrypt, pSched->aucBatch + j * bs);
+        pSched->apBatchCtx[j] = pLane->xOp.pCtx;
+    }
+
+    if (pCtx == NULL)
+        Blocks_MultiKey(pSched->apBatchCtx, pSched->aucBatch, pSched->aucBatch, n, iInverse);
+    else if (iInverse)
+        Blocks_Decrypt(pCtx, pSched->aucBatch, pSched->aucBatch, n);
+    else
+        Blocks_Encrypt(pCtx, pSched->aucBatch, pSched->aucBatch, n);
+
+    for (size_t j = 0; j < n; j++) {
+        pLane = &pSched->aLanes[pui16Lanes[j]];
+        MultiKey_Output(&pLane->xOp, pLane, bs, decrypt, pSched->aucBatch + j * bs);
+    }
+}
+
+/**
+ * @brief Avança cada via um bloco.
+ *
+ * Grupos com ao menos MULTIKEY_SHARED_LANES vias (ou qualquer grupo, sem
+ * o núcleo com várias chaves) vão em um lote aos núcleos em massa do seu
+ * contexto; as demais vias são reunidas por tamanho de bloco, rodadas e
+ * sentido para o núcleo com várias chaves.
+ */
+static void Sched_Step(MultiKeySched *pSched, int decrypt, int iHaveKernel) {
+    uint16_t aui16Single[MULTIKEY_LANES];
+    size_t szSingle = 0, szStart = 0, szLeft, k;
+    const CHIMA_Ctx *pRef;
+    MultiKeyGroup *pGroup;
+    MultiKeyLane *pLane;
+
+    // Ordena as vias por grupo (contagem já mantida em cada grupo)
+    for (size_t a = 0; a < pSched->szActive; a++) {
+        pGroup = &pSched->aGroups[pSched->aui16Active[a]];
+        pGroup->ui32Fill = (uint32_t)szStart;
+        szStart += pGroup->ui32Lanes;
+    }
+    for (size_t l = 0; l < pSched->szLanes; l++)
+        pSched->aui16Order[pSched->aGroups[pSched->aLanes[l].ui32Group].ui32Fill++] = (uint16_t)l;
+
+    szStart = 0;
+    for (size_t a = 0; a < pSched->szActive; a++) {
+        pGroup = &pSched->aGroups[pSched->aui16Active[a]];
+        if (pGroup->ui32Lanes >= MULTIKEY_SHARED_LANES || !iHaveKernel) {
+            Step_Batch(pSched, pSched->aui16Order + szStart, pGroup->ui32Lanes, pGroup->pCtx, decrypt);
+        } else {
+            memcpy(aui16Single + szSingle, pSched->aui16Order + szStart, pGroup->ui32Lanes * sizeof(uint16_t));
+            szSingle += pGroup->ui32Lanes;
+        }
+        szStart += pGroup->ui32Lanes;
+    }
+
+    // Vias de contextos pouco repetidos: um lote por combinação compatível
+    while (szSingle > 0) {
+        pLane = &pSched->aLanes[aui16Single[0]];
+        pRef = pLane->xOp.pCtx;
+        k = 0;
+        szLeft = 0;
+        for (size_t j = 0; j < szSingle; j++) {
+            const MultiKeyLane *pOther = &pSched->aLanes[aui16Single[j]];
+
+            if (pOther->iInverse == pLane->iInverse && pOther->xOp.pCtx->xSize == pRef->xSize
+                && pOther->xOp.pCtx->ui32NumRounds == pRef->ui32NumRounds)
+                pSched->aui16Order[k++] = aui16Single[j];
+            else
+                aui16Single[szLeft++] = aui16Single[j];
+        }
+        Step_Batch(pSched, pSched->aui16Order, k, NULL, decrypt);
+        szSingle = szLeft;
+    }
+}
+
+/**
+ * @brief Várias mensagens, cada uma com o seu contexto, um bloco de cada por passo.
+ *
+ * Até MULTIKEY_LANES mensagens ocupam as vias. Sem o núcleo com várias
+ * chaves, uma mensagem só ocupa uma via se o seu contexto já estiver em
+ * uso ou for o da próxima mensagem; as demais vão direto para *_Buf, assim
+ * como as mensagens longas em modos paralelizáveis.
+ *
+ * @param pfnGet  Obtém cada mensagem
+ * @param pSrc    Vetor de entrada repassado a pfnGet
+ * @param nops    Quantidade de mensagens
+ * @param decrypt 0 para cifrar, 1 para decifrar
+ */
+static void MultiKey_Process(MultiKeyGetFn pfnGet, const void *pSrc, size_t nops, int decrypt) {
+    const CHIMA_Dispatch *pDispatch = CHIMA_GetDispatch();
+    int iHaveKernel = (decrypt ? pDispatch->pfnDecryptMultiKey : pDispatch->pfnEncryptMultiKey) != NULL;
+    MultiKeySched xSched;
+    CHIMA_MultiKeyOp xOp, xPeek;
+    MultiKeyLane *pLane;
+    size_t szNext = 0;
+    int iInverse, iShared;
+    uint32_t bs, slot;
+
+    memset(xSched.ai16Hash, 0xFF, sizeof(xSched.ai16Hash));
+    for (size_t g = 0; g < MULTIKEY_LANES; g++)
+        xSched.aui16Free[g] = (uint16_t)(MULTIKEY_LANES - 1 - g);
+    xSched.szFree = MULTIKEY_LANES;
+    xSched.szActive = 0;
+    xSched.szLanes = 0;
+
+    if (nops > 0)
+        pfnGet(pSrc, 0, &xPeek);
+
+    for (;;) {
+        // Ocupa as vias livres com as próximas mensagens não vazias
+        while (xSched.szLanes < MULTIKEY_LANES && szNext < nops) {
+            xOp = xPeek;
+            if (++szNext < nops)
+                pfnGet(pSrc, szNext, &xPeek);
+            if (xOp.nblocks == 0)
+                continue;
+
+            iInverse = decrypt && (xOp.xMode == CIPHER_MODE_ECB || xOp.xMode == CIPHER_MODE_CBC);
+            if (iHaveKernel) {
+                iShared = 1;
+            } else {
+                // Misturar chaves nas rodadas intercaladas desfaz a previsão
+                // dos desvios da permutação: só entram contextos repetidos
+                iShared = (szNext < nops && xPeek.pCtx == xOp.pCtx)
+                    || Group_Find(&xSched, xOp.pCtx, iInverse, &slot) >= 0;
+            }
+            if (!iShared || (xOp.nblocks >= MULTIKEY_DIRECT_BLOCKS && MultiKey_Parallel(xOp.xMode, decrypt))) {
+                MultiKey_Direct(&xOp, decrypt);
+                continue;
+            }
+
+            bs = (xOp.pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+            pLane = &xSched.aLanes[xSched.szLanes++];
+            pLane->xOp = xOp;
+            pLane->szPos = 0;
+            pLane->iInverse = iInverse;
+            pLane->ui32Group = Group_Acquire(&xSched, xOp.pCtx, iInverse);
+            xSched.aGroups[pLane->ui32Group].ui32Lanes++;
+            if (xOp.xMode != CIPHER_MODE_ECB)
+                Load_Block(xOp.iv, pLane->chain, bs);
+        }
+        if (xSched.szLanes == 0)
+            break;
+
+        Sched_Step(&xSched, decrypt, iHaveKernel);
+
+        // Libera as vias cujas mensagens terminaram
+        for (size_t l = 0; l < xSched.szLanes; ) {
+            pLane = &xSched.aLanes[l];
+            if (pLane->szPos < pLane->xOp.nblocks) {
+                l++;
+                continue;
+            }
+            if (pLane->xOp.xMode != CIPHER_MODE_ECB)
+                Load_Block(pLane->chain, pLane->xOp.iv, (pLane->xOp.pCtx->xSize == BLOCK_MODE_64) ? 8 : 16);
+            if (--xSched.aGroups[pLane->ui32Group].ui32Lanes == 0)
+                Group_Release(&xSched, pLane->ui32Group);
+            *pLane = xSched.aLanes[--xSched.szLanes];
+        }
+    }
+
+    SecureZero(xSched.aucBatch, sizeof(xSched.aucBatch));
+    SecureZero(xSched.aLanes, sizeof(xSched.aLanes));
+}
+
+/**
+ * @brief pfnGet de CHIMA_EncryptCBC_Multi.
+ */
+static void Cbc_Stream_Op(const void *pSrc, size_t szIndex, CHIMA_MultiKeyOp *pOp) {
+    const CHIMA_CbcStream *pStream = (const CHIMA_CbcStream *)pSrc + szIndex;
+
+    pOp->pCtx = pStream->pCtx;
+    pOp->xMode = CIPHER_MODE_CBC;
+    pOp->iv = pStream->iv;
+    pOp->in = pStream->in;
+    pOp->out = pStream->out;
+    pOp->nblocks = pStream->nblocks;
+}
+
+/**
+ * @brief pfnGet de CHIMA_EncryptMultiKey/DecryptMultiKey.
+ */
+static void MultiKey_Op(const void *pSrc, size_t szIndex, CHIMA_MultiKeyOp *pOp) {
+    *pOp = ((const CHIMA_MultiKeyOp *)pSrc)[szIndex];
+}
+
+/**
+ * @brief Modo CBC - Encrypt de várias mensagens independentes
+ *
+ * Cada cadeia CBC é serial, mas cadeias diferentes não dependem umas das
+ * outras. As mensagens passam pelo mesmo escalonador de
+ * CHIMA_EncryptMultiKey: as vias que compartilham o contexto são cifradas
+ * em um lote pelos núcleos em massa, e as de contextos únicos vão ao
+ * núcleo com várias chaves (ou direto para CHIMA_EncryptCBC_Buf, sem ele).
+ * Quando uma mensagem termina, seu iv recebe o último bloco cifrado.
+ *
+ * @param pStreams Mensagens (iv atualizado ao final de cada uma)
+ * @param nstreams Quantidade de mensagens
+ */
+void CHIMA_EncryptCBC_Multi(CHIMA_CbcStream *pStreams, size_t nstreams) {
+    MultiKey_Process(Cbc_Stream_Op, pStreams, nstreams, 0);
+}
+
+/**
+ * @brief Confere as mensagens de CHIMA_EncryptMultiKey/DecryptMultiKey.
+ *
+ * @return 0 se todas forem válidas, -1 caso contrário
+ */
+static int MultiKey_Check(const CHIMA_MultiKeyOp *pOps, size_t nops) {
+    const CHIMA_MultiKeyOp *pOp;
+
+    if (pOps == NULL && nops > 0)
+        return -1;
+    for (size_t i = 0; i < nops; i++) {
+        pOp = &pOps[i];
+        if (pOp->pCtx == NULL || pOp->xMode > CIPHER_MODE_CTR || (pOp->xMode != CIPHER_MODE_ECB && pOp->iv == NULL)
+            || ((pOp->in == NULL || pOp->out == NULL) && pOp->nblocks > 0))
+            return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Cifra várias mensagens curtas, cada uma com a sua chave.
+ *
+ * @param pOps Mensagens (iv atualizado ao final de cada uma)
+ * @param nops Quantidade de mensagens
+ * @return 0 em caso de sucesso, -1 se alguma mensagem for inválida
+ */
+int CHIMA_EncryptMultiKey(CHIMA_MultiKeyOp *pOps, size_t nops) {
+    if (MultiKey_Check(pOps, nops) != 0)
+        return -1;
+    MultiKey_Process(MultiKey_Op, pOps, nops, 0);
+    return 0;
+}
+
+/**
+ * @brief Decifra várias mensagens curtas, cada uma com a sua chave.
+ *
+ * @param pOps Mensagens (iv atualizado ao final de cada uma)
+ * @param nops Quantidade de mensagens
+ * @return 0 em caso de sucesso, -1 se alguma mensagem for inválida
+ */
+int CHIMA_DecryptMultiKey(CHIMA_MultiKeyOp *pOps, size_t nops) {
+    if (MultiKey_Check(pOps, nops) != 0)
+        return -1;
+    MultiKey_Process(MultiKey_Op, pOps, nops, 1);
+    return 0;
+}
+
+/**
+ * @brief Modo CFB - Encrypt de vários blocos
+ *
+ * @param pCtx
+ * @param in
+ * @param out
+ * @param nblocks
+ * @param iv      IV de entrada; recebe o último bloco cifrado
+ */
+void CHIMA_EncryptCFB_Buf(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv) {
+	uint32_t bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    uint8_t feedback[16] = {0}, stream[16] = {0};
+
+    Load_Block(iv, feedback, bs);
+    for (size_t i = 0; i < nblocks; i++, in += bs, out += bs) {
+        Block_Encrypt(pCtx, feedback, stream);
+        XOR_Blocks(feedback, in, stream, bs);
+        Load_Block(feedback, out, bs);
+    }
+    Load_Block(feedback, iv, bs);
+}
+
+/**
+ * @brief Modo CFB - Decrypt de vários blocos
+ *
+ * Todas as entradas da cifra já são conhecidas (IV e blocos cifrados),
+ * então o fluxo é gerado em lotes independentes.
+ *
+ * @param pCtx
+ * @param in
+ * @param out
+ * @param nblocks
+ * @param iv      IV de entrada; recebe o último bloco cifrado
+ */
+void CHIMA_DecryptCFB_Buf(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv) {
+	uint32_t bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    uint8_t feedback[16] = {0}, stream[BULK_BLOCKS * 16];
+    size_t n;
+
+    Load_Block(iv, feedback, bs);
+    while (nblocks > 0) {
+        n = (nblocks < BULK_BLOCKS) ? nblocks : BULK_BLOCKS;
+        Load_Block(feedback, stream, bs);
+        Load_Block(in, stream + bs, (uint32_t)((n - 1) * bs));
+        Load_Block(in + (n - 1) * bs, feedback, bs);
+
+        Blocks_Encrypt(pCtx, stream, stream, n);
+        XOR_Blocks(out, in, stream, (uint32_t)(n * bs));
+
+        in += n * bs;
+        out += n * bs;
+        nblocks -= n;
+    }
+    Load_Block(feedback, iv, bs);
+}
+
+/**
+ * @brief Modo OFB - Encrypt de vários blocos
+ *
+ * @param pCtx
+ * @param in
+ * @param out
+ * @param nblocks
+ * @param iv      IV de entrada; recebe o registrador de realimentação
+ */
+void CHIMA_EncryptOFB_Buf(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv) {
+	uint32_t bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    uint8_t feedback[16] = {0};
+
+    Load_Block(iv, feedback, bs);
+    for (size_t i = 0; i < nblocks; i++, in += bs, out += bs) {
+        Block_Encrypt(pCtx, feedback, feedback);
+        XOR_Blocks(out, in, feedback, bs);
+    }
+    Load_Block(feedback, iv, bs);
+}
+
+/**
+ * @brief Modo OFB - Decrypt de vários blocos
+ *
+ * @param pCtx
+ * @param in
+ * @param out
+ * @param nblocks
+ * @param iv
+ */
+void CHIMA_DecryptOFB_Buf(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv) {
+    CHIMA_EncryptOFB_Buf(pCtx, in, out, nblocks, iv);
+}
+
+/**
+ * @brief Modo CTR - Encrypt de vários blocos
+ *
+ * @param pCtx
+ * @param in
+ * @param out
+ * @param nblocks
+ * @param iv      Contador inicial; recebe o próximo contador
+ */
+void CHIMA_EncryptCTR_Buf(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv) {
+	uint32_t bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    uint8_t stream[BULK_BLOCKS * 16];
+    size_t n;
+
+    while (nblocks > 0) {
+        n = (nblocks < BULK_BLOCKS) ? nblocks : BULK_BLOCKS;
+        for (size_t j = 0; j < n; j++) {
+            Load_Block(iv, stream + j * bs, bs);
+            Counter_Increment(iv, bs);
+        }
+        Blocks_Encrypt(pCtx, stream, stream, n);
+        XOR_Blocks(out, in, stream, (uint32_t)(n * bs));
+
+        in += n * bs;
+        out += n * bs;
+        nblocks -= n;
+    }
+}
+
+/**
+ * @brief Modo CTR - Decrypt de vários blocos
+ *
+ * @param pCtx
+ * @param in
+ * @param out
+ * @param nblocks
+ * @param iv
+ */
+void CHIMA_DecryptCTR_Buf(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv) {
+    CHIMA_EncryptCTR_Buf(pCtx, in, out, nblocks, iv);
 }
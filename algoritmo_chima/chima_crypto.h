@@ -39,6 +39,67 @@
  */
 #define SUBWORD(w0, w1, w2, w3) (w0 = g_AesSBox[w0], w1 = g_AesSBox[w1], w2 = g_AesSBox[w2], w3 = g_AesSBox[w3])
 
+/** Número mínimo de rodadas aceito pela rede Feistel */
+#define CHIMA_MIN_ROUNDS      9
+/** Número máximo de rodadas aceito pela rede Feistel */
+#define CHIMA_MAX_ROUNDS      22
+/** Quantidade de palavras de 32 bits das chaves de rodada (duas por rodada) */
+#define CHIMA_ROUND_KEY_WORDS (2 * CHIMA_MAX_ROUNDS)
+
+
+// TIPOS //
+
+/**
+ * @brief Tabelas opcionais pré-calculadas na preparação da chave.
+ *
+ * Trocam memória por velocidade: cada rodada ganha uma tabela de 256
+ * entradas de 64 bits por byte da metade do bloco (4 no modo de 64 bits,
+ * 8 no de 128 bits).
+ */
+typedef enum {
+    CHIMA_TABLES_NONE,  /**< Sem tabelas: S-Box e permutação calculadas a cada bloco */
+    CHIMA_TABLES_PERM,  /**< Permutação da rodada compilada em tabelas por byte */
+    CHIMA_TABLES_TTABLE /**< Chave, S-Box e permutação fundidas (estilo T-tables do AES) */
+} CHIMA_TableMode;
+
+/**
+ * @brief Contexto com a chave já expandida.
+ *
+ * Inicializado uma única vez por CHIMA_CtxInit e reutilizado em todas as
+ * chamadas *_Ctx, evitando repetir a expansão da chave a cada bloco.
+ */
+typedef struct {
+    uint32_t        aui32RoundKeys[CHIMA_ROUND_KEY_WORDS]; /**< Chaves de rodada */
+    BlockCipherSize xSize;                                 /**< Tamanho do bloco */
+    uint32_t        ui32NumRounds;                         /**< Rodadas da rede Feistel */
+    CHIMA_TableMode xTableMode;                            /**< Tabelas em uso */
+    uint64_t       *pui64Tables;                           /**< Tabelas por rodada (NULL se ausentes) */
+    size_t          szTablesSize;                          /**< Tamanho das tabelas em bytes */
+} CHIMA_Ctx;
+
+/**
+ * @brief Uma mensagem para CHIMA_EncryptCBC_Multi.
+ */
+typedef struct {
+    const CHIMA_Ctx *pCtx;    /**< Contexto da mensagem */
+    uint8_t         *iv;      /**< IV; recebe o último bloco cifrado */
+    const uint8_t   *in;      /**< Blocos claros */
+    uint8_t         *out;     /**< Blocos cifrados (pode ser igual a in) */
+    size_t           nblocks; /**< Quantidade de blocos */
+} CHIMA_CbcStream;
+
+/**
+ * @brief Uma mensagem para CHIMA_EncryptMultiKey/CHIMA_DecryptMultiKey.
+ */
+typedef struct {
+    const CHIMA_Ctx *pCtx;    /**< Contexto (chave) da mensagem */
+    CipherMode       xMode;   /**< Modo de operação */
+    uint8_t         *iv;      /**< IV/contador (ignorado em ECB); atualizado como em *_Buf */
+    const uint8_t   *in;      /**< Blocos de entrada */
+    uint8_t         *out;     /**< Blocos de saída (pode ser igual a in) */
+    size_t           nblocks; /**< Quantidade de blocos */
+} CHIMA_MultiKeyOp;
+
 
 // PROTÓTIPOS DE FUNÇÃO //
 
@@ -65,7 +126,10 @@ void CHIMA_Decipher(const uint8_t *ciphertext, const uint8_t *key, const uint8_t
 
 
 /**
- * @brief Define o número de rodadas do Feistel.
+ * @brief Define o número de rodadas usado pelas funções sem contexto.
+ *
+ * Não afeta CHIMA_Cipher/CHIMA_Decipher nem as funções *_Ctx, que recebem
+ * as rodadas por chamada ou pelo contexto e podem ser usadas em paralelo.
  */
 void CHIMA_setNumberOfRounds(uint8_t ui8Set);
 
@@ -96,4 +160,122 @@ void CHIMA_DecryptCTR(const uint8_t *ciphertext, const uint8_t *key, const uint8
                 uint8_t *plaintext, BlockCipherSize mode);
 
 
+/**
+ * @brief Expande a chave uma única vez e prepara o contexto.
+ *
+ * O contexto começa sem tabelas. Se CHIMA_CtxSetTables for usado, libere
+ * com CHIMA_CtxFree antes de reinicializar ou descartar o contexto.
+ * @return 0 em caso de sucesso, -1 se o número de rodadas for inválido
+ */
+int  CHIMA_CtxInit(CHIMA_Ctx *pCtx, const uint8_t *key, BlockCipherSize xSize, uint32_t ui32NumRounds);
+
+/**
+ * @brief Pré-calcula as tabelas por rodada no contexto.
+ *
+ * Tabelas anteriores são liberadas. CHIMA_TABLES_NONE apenas as remove.
+ * @return Tamanho das tabelas alocadas em bytes (0 se nenhuma ou em falha)
+ */
+size_t CHIMA_CtxSetTables(CHIMA_Ctx *pCtx, CHIMA_TableMode xTableMode);
+
+/**
+ * @brief Informa a memória ocupada pelas tabelas do contexto.
+ */
+size_t CHIMA_CtxTablesSize(const CHIMA_Ctx *pCtx);
+
+/**
+ * @brief Apaga as chaves do contexto e libera as tabelas, se houver.
+ */
+void CHIMA_CtxFree(CHIMA_Ctx *pCtx);
+
+/**
+ * @brief Cifra um bloco usando um contexto já inicializado.
+ */
+void CHIMA_Cipher_Ctx(const CHIMA_Ctx *pCtx, const uint8_t *plaintext, const uint8_t *iv,
+     uint8_t *ciphertext, CipherMode xMode);
+
+/**
+ * @brief Decifra um bloco usando um contexto já inicializado.
+ */
+void CHIMA_Decipher_Ctx(const CHIMA_Ctx *pCtx, const uint8_t *ciphertext, const uint8_t *iv,
+     uint8_t *decrypted, CipherMode xMode);
+
+void CHIMA_EncryptECB_Ctx(const CHIMA_Ctx *pCtx, const uint8_t *plaintext, uint8_t *ciphertext);
+void CHIMA_DecryptECB_Ctx(const CHIMA_Ctx *pCtx, const uint8_t *ciphertext, uint8_t *plaintext);
+
+void CHIMA_EncryptCBC_Ctx(const CHIMA_Ctx *pCtx, const uint8_t *plaintext,  const uint8_t *iv, uint8_t *ciphertext);
+void CHIMA_DecryptCBC_Ctx(const CHIMA_Ctx *pCtx, const uint8_t *ciphertext, const uint8_t *iv, uint8_t *plaintext);
+
+void CHIMA_EncryptCFB_Ctx(const CHIMA_Ctx *pCtx, const uint8_t *plaintext,  const uint8_t *iv, uint8_t *ciphertext);
+void CHIMA_DecryptCFB_Ctx(const CHIMA_Ctx *pCtx, const uint8_t *ciphertext, const uint8_t *iv, uint8_t *plaintext);
+
+void CHIMA_EncryptOFB_Ctx(const CHIMA_Ctx *pCtx, const uint8_t *plaintext,  const uint8_t *iv, uint8_t *ciphertext);
+void CHIMA_DecryptOFB_Ctx(const CHIMA_Ctx *pCtx, const uint8_t *ciphertext, const uint8_t *iv, uint8_t *plaintext);
+
+void CHIMA_EncryptCTR_Ctx(const CHIMA_Ctx *pCtx, const uint8_t *plaintext,  const uint8_t *iv, uint8_t *ciphertext);
+void CHIMA_DecryptCTR_Ctx(const CHIMA_Ctx *pCtx, const uint8_t *ciphertext, const uint8_t *iv, uint8_t *plaintext);
+
+
+/*
+ * Variantes em massa: processam nblocks blocos consecutivos encadeando
+ * corretamente entre eles. O iv é atualizado ao final com o próximo valor
+ * de encadeamento (último bloco cifrado em CBC/CFB, registrador de
+ * realimentação em OFB e próximo contador em CTR), permitindo continuar o
+ * fluxo em uma chamada posterior. O contador do CTR é incrementado como
+ * inteiro big-endian do tamanho do bloco.
+ *
+ * out pode ser igual a in (cifragem no próprio buffer), mas não pode
+ * sobrepô-lo parcialmente.
+ */
+
+void CHIMA_EncryptECB_Buf(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks);
+void CHIMA_DecryptECB_Buf(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks);
+
+void CHIMA_EncryptCBC_Buf(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv);
+void CHIMA_DecryptCBC_Buf(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv);
+
+void CHIMA_EncryptCFB_Buf(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv);
+void CHIMA_DecryptCFB_Buf(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv);
+
+void CHIMA_EncryptOFB_Buf(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv);
+void CHIMA_DecryptOFB_Buf(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv);
+
+void CHIMA_EncryptCTR_Buf(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv);
+void CHIMA_DecryptCTR_Buf(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv);
+
+/**
+ * @brief Cifra em CBC várias mensagens independentes em paralelo.
+ *
+ * As mensagens avançam juntas, um bloco de cada por passo, para que os
+ * núcleos em massa recebam um bloco de cada cadeia; as que compartilham
+ * o mesmo contexto são cifradas no mesmo lote e as de contextos diferentes
+ * vão ao núcleo com várias chaves, como em CHIMA_EncryptMultiKey. O
+ * resultado de cada mensagem é igual ao de CHIMA_EncryptCBC_Buf.
+ */
+void CHIMA_EncryptCBC_Multi(CHIMA_CbcStream *pStreams, size_t nstreams);
+
+/**
+ * @brief Cifra ou decifra várias mensagens curtas, cada uma com a sua chave.
+ *
+ * Pensado para muitas chaves com poucos blocos cada: as mensagens avançam
+ * juntas, um bloco de cada por passo, e os blocos de um passo vão juntos
+ * para o núcleo com várias chaves, em que cada via usa as chaves de rodada
+ * do seu contexto. Nenhuma chave é expandida de novo. Mensagens longas em
+ * modos paralelizáveis vão direto para as funções *_Buf. Sem o núcleo com
+ * várias chaves (AES-NI e BMI2), também vão direto as mensagens cujo
+ * contexto não se repete entre as vias ou na mensagem seguinte; as
+ * mensagens com o mesmo contexto ocupam um lote dos núcleos em massa.
+ * Contextos com
+ * tamanhos de bloco ou rodadas diferentes podem ser misturados, mas só os
+ * iguais ocupam o mesmo lote. O resultado de cada mensagem é igual ao da
+ * função *_Buf do seu modo.
+ *
+ * @param pOps Mensagens (iv atualizado ao final de cada uma)
+ * @param nops Quantidade de mensagens
+ * @return 0 em caso de sucesso, -1 se alguma mensagem for inválida (nada
+ *         é processado)
+ */
+int CHIMA_EncryptMultiKey(CHIMA_MultiKeyOp *pOps, size_t nops);
+int CHIMA_DecryptMultiKey(CHIMA_MultiKeyOp *pOps, size_t nops);
+
+
 #endif /* CRYPTOGRAPHY_H */
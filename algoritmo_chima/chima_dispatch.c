@@ -0,0 +1,311 @@
+/**
+ * @file chima_dispatch.c
+ * @author
+ * @brief Detecção de extensões do processador e tabela de despacho.
+ * @version
+ * @date 2025-06-13
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * O cpuid é consultado uma única vez, no primeiro uso da biblioteca (ou
+ * em CHIMA_DispatchInit). A partir das extensões encontradas cada módulo
+ * escolhe as próprias implementações e o resultado fica em uma tabela
+ * imutável; as chamadas seguintes pagam só uma leitura atômica e uma
+ * chamada indireta. A variável de ambiente CHIMA_BACKEND força um
+ * backend, o que permite comparar implementações na mesma máquina.
+ */
+
+
+// INCLUSÕES //
+
+#include "chima_kernels.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(CHIMA_X86_DISPATCH)
+#include <cpuid.h>
+#endif
+
+
+// DEFINIÇÕES //
+
+/** Bits de XCR0: estado SSE e AVX salvos pelo sistema operacional */
+#define XCR0_AVX    0x06u
+/** Bits de XCR0: estado AVX-512 (opmask, ZMM baixos e altos) */
+#define XCR0_AVX512 0xE0u
+
+
+// VARIÁVEIS GLOBAIS //
+
+/** Tabela preenchida uma única vez */
+static CHIMA_Dispatch g_xDispatch;
+/** Aponta para g_xDispatch depois que ela está completa */
+static _Atomic(const CHIMA_Dispatch *) g_pDispatch = NULL;
+/** Trava da inicialização */
+static atomic_flag g_xInitLock = ATOMIC_FLAG_INIT;
+
+/** Nomes aceitos em CHIMA_BACKEND, indexados por CHIMA_Backend */
+static const char *const g_apszBackendNames[] = {
+    "auto", "generic", "bitslice", "aesni", "avx2", "avx512"
+};
+
+
+// FUNÇÕES //
+
+/**
+ * @brief Consulta as extensões do processador.
+ *
+ * As extensões AVX só são relatadas quando o sistema operacional salva
+ * os registradores correspondentes (OSXSAVE e XCR0).
+ *
+ * @return Combinação de CHIMA_CpuFeature
+ */
+static uint32_t Probe_Cpu(void) {
+    uint32_t features = 0;
+#if defined(CHIMA_X86_DISPATCH)
+    unsigned int eax, ebx, ecx, edx, max_leaf, xcr0 = 0, xcr0_high;
+
+    max_leaf = __get_cpuid_max(0, NULL);
+    if (max_leaf < 1 || !__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return 0;
+
+    if (ecx & (1u << 1))  features |= CHIMA_CPU_PCLMUL;
+    if (ecx & (1u << 9))  features |= CHIMA_CPU_SSSE3;
+    if (ecx & (1u << 25)) features |= CHIMA_CPU_AESNI;
+    if ((ecx & (1u << 27)) && (ecx & (1u << 28))) {
+        __asm__ volatile ("xgetbv" : "=a"(xcr0), "=d"(xcr0_high) : "c"(0));
+        (void)xcr0_high;
+    }
+
+    if (max_leaf >= 7) {
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+        if (ebx & (1u << 8))
+            features |= CHIMA_CPU_BMI2;
+        if (ecx & (1u << 8))
+            features |= CHIMA_CPU_GFNI;
+        if ((xcr0 & XCR0_AVX) == XCR0_AVX && (ebx & (1u << 5)))
+            features |= CHIMA_CPU_AVX2;
+        // F, BW e VBMI, com o estado AVX-512 habilitado
+        if ((xcr0 & (XCR0_AVX | XCR0_AVX512)) == (XCR0_AVX | XCR0_AVX512) &&
+            (ebx & (1u << 16)) && (ebx & (1u << 30)) && (ecx & (1u << 1)))
+            features |= CHIMA_CPU_AVX512;
+    }
+#endif
+    return features;
+}
+
+/**
+ * @brief Lê o backend pedido em CHIMA_BACKEND.
+ *
+ * @return Backend pedido (CHIMA_BACKEND_AUTO se ausente ou desconhecido)
+ */
+static CHIMA_Backend Requested_Backend(void) {
+    const char *pszValue = getenv(CHIMA_BACKEND_ENV);
+
+    if (pszValue == NULL)
+        return CHIMA_BACKEND_AUTO;
+    for (int b = 0; b < (int)(sizeof(g_apszBackendNames) / sizeof(g_apszBackendNames[0])); b++)
+        if (strcmp(pszValue, g_apszBackendNames[b]) == 0)
+            return (CHIMA_Backend)b;
+    return CHIMA_BACKEND_AUTO;
+}
+
+/**
+ * @brief Indica se o processador suporta o backend.
+ *
+ * @param xBackend Backend
+ * @param features Extensões detectadas
+ * @return 1 se o backend pode ser usado
+ */
+static int Backend_Supported(CHIMA_Backend xBackend, uint32_t features) {
+    switch (xBackend) {
+#if defined(CHIMA_HAVE_AESNI)
+        case CHIMA_BACKEND_AESNI:
+            return (features & CHIMA_CPU_FAST_ROUNDS) == CHIMA_CPU_FAST_ROUNDS;
+#endif
+#if defined(CHIMA_HAVE_AVX2)
+        case CHIMA_BACKEND_AVX2:
+            return (features & CHIMA_CPU_AVX2) != 0;
+#endif
+#if defined(CHIMA_HAVE_AVX512)
+        case CHIMA_BACKEND_AVX512:
+            return (features & (CHIMA_CPU_AVX512 | CHIMA_CPU_GFNI)) == (CHIMA_CPU_AVX512 | CHIMA_CPU_GFNI);
+#endif
+        case CHIMA_BACKEND_AUTO:
+        case CHIMA_BACKEND_GENERIC:
+        case CHIMA_BACKEND_BITSLICE:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief Acrescenta um núcleo em massa à cadeia.
+ *
+ * @param pDispatch Tabela em construção
+ * @param pCount    Núcleos já presentes
+ * @param pfnEnc    Núcleo de cifragem
+ * @param pfnDec    Núcleo de decifração
+ */
+static void Add_Kernel(CHIMA_Dispatch *pDispatch, int *pCount, CHIMA_BlocksFn pfnEnc, CHIMA_BlocksFn pfnDec) {
+    pDispatch->apfnEncryptBlocks[*pCount] = pfnEnc;
+    pDispatch->apfnDecryptBlocks[*pCount] = pfnDec;
+    (*pCount)++;
+}
+
+#if defined(CHIMA_HAVE_AVX512)
+/**
+ * @brief Núcleo AVX-512 da cadeia automática: só aceita lotes grandes.
+ *
+ * Lotes menores que CHIMA_AVX512_MIN_BLOCKS seguem para o próximo núcleo.
+ */
+static size_t AVX512_EncryptLarge(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t n) {
+    return (n < CHIMA_AVX512_MIN_BLOCKS) ? 0 : CHIMA_AVX512_EncryptBlocks(pCtx, in, out, n);
+}
+
+/**
+ * @brief Versão de decifração de AVX512_EncryptLarge.
+ */
+static size_t AVX512_DecryptLarge(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t n) {
+    return (n < CHIMA_AVX512_MIN_BLOCKS) ? 0 : CHIMA_AVX512_DecryptBlocks(pCtx, in, out, n);
+}
+#endif
+
+/**
+ * @brief Monta a tabela de despacho.
+ *
+ * No modo automático a cadeia segue a vazão medida nos dois tamanhos de
+ * bloco: AVX-512 (16 blocos) só para lotes de CHIMA_AVX512_MIN_BLOCKS ou
+ * mais, bitsliced (128), AVX2 (8) e AES-NI (4); o que sobra vai para o
+ * caminho escalar. Um backend forçado deixa apenas o seu núcleo
+ * na cadeia e limita as primitivas às extensões que ele usa.
+ *
+ * @param pDispatch Tabela a preencher
+ */
+static void Build_Dispatch(CHIMA_Dispatch *pDispatch) {
+    uint32_t features = Probe_Cpu();
+    CHIMA_Backend xBackend = Requested_Backend();
+    int count = 0;
+
+    memset(pDispatch, 0, sizeof(*pDispatch));
+    if (!Backend_Supported(xBackend, features))
+        xBackend = CHIMA_BACKEND_AUTO;
+
+    switch (xBackend) {
+        case CHIMA_BACKEND_GENERIC:
+        case CHIMA_BACKEND_BITSLICE:
+            features = 0;
+            break;
+        case CHIMA_BACKEND_AESNI:
+            features &= CHIMA_CPU_FAST_ROUNDS | CHIMA_CPU_PCLMUL;
+            break;
+        case CHIMA_BACKEND_AVX2:
+            features &= CHIMA_CPU_FAST_ROUNDS | CHIMA_CPU_PCLMUL | CHIMA_CPU_AVX2;
+            break;
+        default:
+            break;
+    }
+    pDispatch->ui32Features = features;
+
+    if (xBackend == CHIMA_BACKEND_AUTO) {
+#if defined(CHIMA_HAVE_AVX512)
+        if (Backend_Supported(CHIMA_BACKEND_AVX512, features))
+            Add_Kernel(pDispatch, &count, AVX512_EncryptLarge, AVX512_DecryptLarge);
+#endif
+        Add_Kernel(pDispatch, &count, CHIMA_BITSLICE_EncryptBlocks, CHIMA_BITSLICE_DecryptBlocks);
+#if defined(CHIMA_HAVE_AVX2)
+        if (Backend_Supported(CHIMA_BACKEND_AVX2, features))
+            Add_Kernel(pDispatch, &count, CHIMA_AVX2_EncryptBlocks, CHIMA_AVX2_DecryptBlocks);
+#endif
+#if defined(CHIMA_HAVE_AESNI)
+        if (Backend_Supported(CHIMA_BACKEND_AESNI, features))
+            Add_Kernel(pDispatch, &count, CHIMA_AESNI_EncryptBlocks, CHIMA_AESNI_DecryptBlocks);
+#endif
+        // O backend relatado é o primeiro núcleo da cadeia
+        if (pDispatch->apfnEncryptBlocks[0] == CHIMA_BITSLICE_EncryptBlocks)
+            xBackend = CHIMA_BACKEND_BITSLICE;
+        else
+            xBackend = CHIMA_BACKEND_AVX512;
+    } else if (xBackend == CHIMA_BACKEND_BITSLICE) {
+        Add_Kernel(pDispatch, &count, CHIMA_BITSLICE_EncryptBlocks, CHIMA_BITSLICE_DecryptBlocks);
+#if defined(CHIMA_HAVE_AESNI)
+    } else if (xBackend == CHIMA_BACKEND_AESNI) {
+        Add_Kernel(pDispatch, &count, CHIMA_AESNI_EncryptBlocks, CHIMA_AESNI_DecryptBlocks);
+#endif
+#if defined(CHIMA_HAVE_AVX2)
+    } else if (xBackend == CHIMA_BACKEND_AVX2) {
+        Add_Kernel(pDispatch, &count, CHIMA_AVX2_EncryptBlocks, CHIMA_AVX2_DecryptBlocks);
+#endif
+#if defined(CHIMA_HAVE_AVX512)
+    } else if (xBackend == CHIMA_BACKEND_AVX512) {
+        Add_Kernel(pDispatch, &count, CHIMA_AVX512_EncryptBlocks, CHIMA_AVX512_DecryptBlocks);
+#endif
+    }
+    pDispatch->xBackend = xBackend;
+
+    CHIMA_BindCrypto(pDispatch);
+    CHIMA_BindLesamnta(pDispatch);
+    CHIMA_BindGhash(pDispatch);
+}
+
+/**
+ * @brief Detecta o processador e escolhe as implementações.
+ */
+void CHIMA_DispatchInit(void) {
+    (void)CHIMA_GetDispatch();
+}
+
+/**
+ * @brief Tabela de despacho, preenchida no primeiro uso.
+ *
+ * A primeira thread monta a tabela sob uma trava simples; as demais
+ * esperam a publicação do ponteiro.
+ *
+ * @return Implementações escolhidas
+ */
+const CHIMA_Dispatch *CHIMA_GetDispatch(void) {
+    const CHIMA_Dispatch *pDispatch = atomic_load_explicit(&g_pDispatch, memory_order_acquire);
+
+    if (pDispatch != NULL)
+        return pDispatch;
+
+    while (atomic_flag_test_and_set_explicit(&g_xInitLock, memory_order_acquire))
+        ;
+    pDispatch = atomic_load_explicit(&g_pDispatch, memory_order_acquire);
+    if (pDispatch == NULL) {
+        Build_Dispatch(&g_xDispatch);
+        pDispatch = &g_xDispatch;
+        atomic_store_explicit(&g_pDispatch, pDispatch, memory_order_release);
+    }
+    atomic_flag_clear_explicit(&g_xInitLock, memory_order_release);
+    return pDispatch;
+}
+
+/**
+ * @brief Extensões em uso, já filtradas pela variável CHIMA_BACKEND.
+ *
+ * @return Combinação de CHIMA_CpuFeature
+ */
+uint32_t CHIMA_CpuFeatures(void) {
+    return CHIMA_GetDispatch()->ui32Features;
+}
+
+/**
+ * @brief Backend principal escolhido.
+ *
+ * @return Backend em uso
+ */
+CHIMA_Backend CHIMA_GetBackend(void) {
+    return CHIMA_GetDispatch()->xBackend;
+}
+
+/**
+ * @brief Nome do backend principal escolhido.
+ *
+ * @return Nome no mesmo formato aceito por CHIMA_BACKEND
+ */
+const char *CHIMA_BackendName(void) {
+    return g_apszBackendNames[CHIMA_GetBackend()];
+}
@@ -0,0 +1,91 @@
+/**
+ * @file chima_dispatch.h
+ * @author
+ * @brief Detecção de extensões do processador e escolha dos backends.
+ * @version
+ * @date 2025-06-13
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef CHIMA_DISPATCH_H
+#define CHIMA_DISPATCH_H
+
+
+// INCLUSÕES //
+
+#include <stdint.h>
+
+
+// DEFINIÇÕES //
+
+/** Variável de ambiente que força um backend (ver CHIMA_Backend) */
+#define CHIMA_BACKEND_ENV "CHIMA_BACKEND"
+
+
+// TIPOS //
+
+/**
+ * @brief Extensões do processador detectadas via cpuid.
+ */
+typedef enum {
+    CHIMA_CPU_BMI2   = 1u << 0, /**< PDEP/PEXT */
+    CHIMA_CPU_SSSE3  = 1u << 1, /**< PSHUFB */
+    CHIMA_CPU_AESNI  = 1u << 2, /**< AESENC/AESENCLAST */
+    CHIMA_CPU_PCLMUL = 1u << 3, /**< Multiplicação sem vai-um */
+    CHIMA_CPU_AVX2   = 1u << 4, /**< AVX2 com suporte do sistema operacional */
+    CHIMA_CPU_GFNI   = 1u << 5, /**< Instruções de campo de Galois */
+    CHIMA_CPU_AVX512 = 1u << 6  /**< AVX-512 F/BW/VBMI com suporte do sistema operacional */
+} CHIMA_CpuFeature;
+
+/**
+ * @brief Backend principal das funções em massa.
+ *
+ * Valores aceitos em CHIMA_BACKEND: "auto", "generic", "bitslice",
+ * "aesni", "avx2" e "avx512". Um backend forçado que o processador não
+ * suporta é ignorado (equivale a "auto").
+ */
+typedef enum {
+    CHIMA_BACKEND_AUTO,     /**< Melhor combinação disponível */
+    CHIMA_BACKEND_GENERIC,  /**< Somente C portátil, sem núcleos em massa */
+    CHIMA_BACKEND_BITSLICE, /**< Núcleo bitsliced portátil */
+    CHIMA_BACKEND_AESNI,    /**< AES-NI + BMI2 */
+    CHIMA_BACKEND_AVX2,     /**< AVX2 */
+    CHIMA_BACKEND_AVX512    /**< AVX-512 + GFNI */
+} CHIMA_Backend;
+
+
+// PROTÓTIPOS DE FUNÇÃO //
+
+/**
+ * @brief Detecta o processador e escolhe as implementações.
+ *
+ * Chamada automaticamente no primeiro uso; pode ser chamada antes para
+ * tirar a detecção do caminho crítico. É segura entre threads.
+ */
+void CHIMA_DispatchInit(void);
+
+/**
+ * @brief Extensões em uso, já filtradas pela variável CHIMA_BACKEND.
+ *
+ * @return Combinação de CHIMA_CpuFeature
+ */
+uint32_t CHIMA_CpuFeatures(void);
+
+/**
+ * @brief Backend principal escolhido.
+ *
+ * @return Backend em uso
+ */
+CHIMA_Backend CHIMA_GetBackend(void);
+
+/**
+ * @brief Nome do backend principal escolhido.
+ *
+ * @return Nome no mesmo formato aceito por CHIMA_BACKEND
+ */
+const char *CHIMA_BackendName(void);
+
+
+#endif /* CHIMA_DISPATCH_H */
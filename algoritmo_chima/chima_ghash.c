@@ -0,0 +1,245 @@
+/**
+ * @file chima_ghash.c
+ * @author
+ * @brief GHASH (multiplicação por H em GF(2^128)) do modo GCM.
+ * @version
+ * @date 2025-06-13
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Duas implementações com o mesmo resultado: uma por tabelas de 4 bits
+ * (16 múltiplos de H, método de Shoup) para qualquer processador e outra
+ * com PCLMULQDQ, que agrega quatro blocos por vez com H^4..H^1 e faz uma
+ * única redução módulo x^128 + x^7 + x^2 + x + 1 a cada quatro blocos.
+ */
+
+
+// INCLUSÕES //
+
+#include "chima_kernels.h"
+#include <string.h>
+
+
+// VARIÁVEIS GLOBAIS //
+
+/** Redução dos 4 bits que saem pela direita em cada deslocamento */
+static const uint64_t g_aui64Last4[16] = {
+    0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+    0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0
+};
+
+
+// FUNÇÕES //
+
+/**
+ * @brief Lê 8 bytes como inteiro big-endian.
+ */
+static uint64_t Load_BE64(const uint8_t *p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+/**
+ * @brief Grava um inteiro como 8 bytes big-endian.
+ */
+static void Store_BE64(uint8_t *p, uint64_t v) {
+    for (int i = 7; i >= 0; i--, v >>= 8)
+        p[i] = (uint8_t)v;
+}
+
+/**
+ * @brief Multiplica x por H usando as tabelas de 4 bits.
+ *
+ * @param pKey Chave do GHASH
+ * @param x    Elemento de 16 bytes; recebe x * H
+ */
+static void Gf_Mul_Table(const CHIMA_GhashKey *pKey, uint8_t *x) {
+    uint64_t zh, zl, rem;
+    uint8_t lo, hi;
+
+    lo = x[15] & 0x0F;
+    zh = pKey->aui64HH[lo];
+    zl = pKey->aui64HL[lo];
+
+    for (int i = 15; i >= 0; i--) {
+        lo = x[i] & 0x0F;
+        hi = (x[i] >> 4) & 0x0F;
+
+        if (i != 15) {
+            rem = zl & 0x0F;
+            zl = (zh << 60) | (zl >> 4);
+            zh = (zh >> 4) ^ (g_aui64Last4[rem] << 48);
+            zh ^= pKey->aui64HH[lo];
+            zl ^= pKey->aui64HL[lo];
+        }
+        rem = zl & 0x0F;
+        zl = (zh << 60) | (zl >> 4);
+        zh = (zh >> 4) ^ (g_aui64Last4[rem] << 48);
+        zh ^= pKey->aui64HH[hi];
+        zl ^= pKey->aui64HL[hi];
+    }
+
+    Store_BE64(x, zh);
+    Store_BE64(x + 8, zl);
+}
+
+/**
+ * @brief GHASH portátil: x = (x ^ bloco) * H para cada bloco.
+ *
+ * @param pucX    Acumulador de 16 bytes
+ * @param pKey    Chave do GHASH
+ * @param data    Blocos de 16 bytes
+ * @param nblocks Quantidade de blocos
+ */
+static void Ghash_Table(uint8_t *pucX, const CHIMA_GhashKey *pKey, const uint8_t *data, size_t nblocks) {
+    for (size_t i = 0; i < nblocks; i++, data += 16) {
+        XOR_Blocks(pucX, pucX, data, 16);
+        Gf_Mul_Table(pKey, pucX);
+    }
+}
+
+#if defined(CHIMA_X86_DISPATCH)
+/**
+ * @brief Produto sem carry de 128 x 128 bits, acumulado em (lo, hi).
+ */
+static inline CHIMA_TARGET("pclmul,sse2") void Clmul_Acc(__m128i a, __m128i b, __m128i *pLo, __m128i *pHi) {
+    __m128i lo = _mm_clmulepi64_si128(a, b, 0x00);
+    __m128i hi = _mm_clmulepi64_si128(a, b, 0x11);
+    __m128i mid = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01));
+
+    *pLo = _mm_xor_si128(*pLo, _mm_xor_si128(lo, _mm_slli_si128(mid, 8)));
+    *pHi = _mm_xor_si128(*pHi, _mm_xor_si128(hi, _mm_srli_si128(mid, 8)));
+}
+
+/**
+ * @brief Reduz um produto de 256 bits para GF(2^128).
+ *
+ * Os operandos estão com os bytes invertidos e os bits na ordem refletida
+ * do GCM, então o produto é deslocado um bit à esquerda antes da redução.
+ */
+static inline CHIMA_TARGET("pclmul,sse2") __m128i Gf_Reduce(__m128i lo, __m128i hi) {
+    __m128i t7, t8, t9, t2, t4, t5;
+
+    // Deslocamento de 1 bit do valor de 256 bits hi:lo
+    t7 = _mm_srli_epi32(lo, 31);
+    t8 = _mm_srli_epi32(hi, 31);
+    lo = _mm_slli_epi32(lo, 1);
+    hi = _mm_slli_epi32(hi, 1);
+    t9 = _mm_srli_si128(t7, 12);
+    t8 = _mm_slli_si128(t8, 4);
+    t7 = _mm_slli_si128(t7, 4);
+    lo = _mm_or_si128(lo, t7);
+    hi = _mm_or_si128(hi, t8);
+    hi = _mm_or_si128(hi, t9);
+
+    // Redução módulo x^128 + x^7 + x^2 + x + 1
+    t7 = _mm_slli_epi32(lo, 31);
+    t8 = _mm_slli_epi32(lo, 30);
+    t9 = _mm_slli_epi32(lo, 25);
+    t7 = _mm_xor_si128(t7, _mm_xor_si128(t8, t9));
+    t8 = _mm_srli_si128(t7, 4);
+    t7 = _mm_slli_si128(t7, 12);
+    lo = _mm_xor_si128(lo, t7);
+
+    t2 = _mm_srli_epi32(lo, 1);
+    t4 = _mm_srli_epi32(lo, 2);
+    t5 = _mm_srli_epi32(lo, 7);
+    t2 = _mm_xor_si128(t2, _mm_xor_si128(t4, _mm_xor_si128(t5, t8)));
+    lo = _mm_xor_si128(lo, t2);
+    return _mm_xor_si128(hi, lo);
+}
+
+/**
+ * @brief GHASH com PCLMULQDQ, quatro blocos por redução.
+ *
+ * @param pucX    Acumulador de 16 bytes
+ * @param pKey    Chave do GHASH
+ * @param data    Blocos de 16 bytes
+ * @param nblocks Quantidade de blocos
+ */
+static CHIMA_TARGET("pclmul,ssse3") void Ghash_PCLMUL(uint8_t *pucX, const CHIMA_GhashKey *pKey, const uint8_t *data, size_t nblocks) {
+    const __m128i bswap = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    const __m128i h1 = _mm_loadu_si128((const __m128i *)pKey->aucHPow[0]);
+    const __m128i h2 = _mm_loadu_si128((const __m128i *)pKey->aucHPow[1]);
+    const __m128i h3 = _mm_loadu_si128((const __m128i *)pKey->aucHPow[2]);
+    const __m128i h4 = _mm_loadu_si128((const __m128i *)pKey->aucHPow[3]);
+    __m128i x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)pucX), bswap);
+    __m128i lo, hi, b0, b1, b2, b3;
+
+    for (; nblocks >= 4; nblocks -= 4, data += 64) {
+        b0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 0)), bswap);
+        b1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16)), bswap);
+        b2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 32)), bswap);
+        b3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 48)), bswap);
+
+        lo = hi = _mm_setzero_si128();
+        Clmul_Acc(_mm_xor_si128(x, b0), h4, &lo, &hi);
+        Clmul_Acc(b1, h3, &lo, &hi);
+        Clmul_Acc(b2, h2, &lo, &hi);
+        Clmul_Acc(b3, h1, &lo, &hi);
+        x = Gf_Reduce(lo, hi);
+    }
+    for (; nblocks > 0; nblocks--, data += 16) {
+        b0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)data), bswap);
+        lo = hi = _mm_setzero_si128();
+        Clmul_Acc(_mm_xor_si128(x, b0), h1, &lo, &hi);
+        x = Gf_Reduce(lo, hi);
+    }
+
+    _mm_storeu_si128((__m128i *)pucX, _mm_shuffle_epi8(x, bswap));
+}
+#endif
+
+/**
+ * @brief Pré-calcula a chave do GHASH a partir de H.
+ *
+ * @param pKey Chave do GHASH
+ * @param pucH H (16 bytes)
+ */
+void CHIMA_GhashSetKey(CHIMA_GhashKey *pKey, const uint8_t *pucH) {
+    uint64_t vh = Load_BE64(pucH), vl = Load_BE64(pucH + 8), t;
+    uint8_t aucPow[16];
+
+    // Tabelas de 4 bits: HH/HL[i] = i * H, com os bits em ordem refletida
+    pKey->aui64HH[0] = pKey->aui64HL[0] = 0;
+    pKey->aui64HH[8] = vh;
+    pKey->aui64HL[8] = vl;
+    for (int i = 4; i > 0; i >>= 1) {
+        t = (vl & 1) * 0xe1000000U;
+        vl = (vh << 63) | (vl >> 1);
+        vh = (vh >> 1) ^ (t << 32);
+        pKey->aui64HH[i] = vh;
+        pKey->aui64HL[i] = vl;
+    }
+    for (int i = 2; i <= 8; i *= 2) {
+        for (int j = 1; j < i; j++) {
+            pKey->aui64HH[i + j] = pKey->aui64HH[i] ^ pKey->aui64HH[j];
+            pKey->aui64HL[i + j] = pKey->aui64HL[i] ^ pKey->aui64HL[j];
+        }
+    }
+
+    // Potências de H para a agregação com PCLMULQDQ
+    memcpy(aucPow, pucH, 16);
+    for (int p = 0; p < 4; p++) {
+        if (p > 0)
+            Gf_Mul_Table(pKey, aucPow);
+        for (int i = 0; i < 16; i++)
+            pKey->aucHPow[p][i] = aucPow[15 - i];
+    }
+    SecureZero(aucPow, sizeof(aucPow));
+}
+
+/**
+ * @brief Escolhe a implementação do GHASH.
+ *
+ * @param pDispatch Tabela em construção, com ui32Features preenchido
+ */
+void CHIMA_BindGhash(CHIMA_Dispatch *pDispatch) {
+    pDispatch->pfnGhash = Ghash_Table;
+#if defined(CHIMA_X86_DISPATCH)
+    if ((pDispatch->ui32Features & (CHIMA_CPU_PCLMUL | CHIMA_CPU_SSSE3)) == (CHIMA_CPU_PCLMUL | CHIMA_CPU_SSSE3))
+        pDispatch->pfnGhash = Ghash_PCLMUL;
+#endif
+}
@@ -0,0 +1,270 @@
+/**
+ * @file chima_iov.c
+ * @author
+ * @brief Cifragem no próprio buffer e sobre listas de segmentos (iovec).
+ * @version
+ * @date 2025-06-13
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * As listas de entrada e saída são percorridas com um cursor cada. A cada
+ * passo o maior trecho de blocos inteiros que cabe no segmento corrente
+ * das duas listas é entregue direto à função *_Buf do modo; o encadeamento
+ * fica no iv entre os trechos, então o resultado é o mesmo de uma única
+ * chamada sobre os dados contíguos.
+ */
+
+
+// INCLUSÕES //
+
+#include "chima_iov.h"
+#include <string.h>
+
+
+// TIPOS //
+
+/** Função em massa de um modo, com a assinatura das variantes *_Buf */
+typedef void (*BufFn)(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv);
+
+/** Posição corrente em uma lista de segmentos */
+typedef struct {
+    const struct iovec *pIov;  /**< Segmento corrente */
+    const struct iovec *pEnd;  /**< Fim da lista */
+    size_t              szOff; /**< Bytes já consumidos do segmento corrente */
+} IovCursor;
+
+
+// FUNÇÕES //
+
+/**
+ * @brief ECB com a assinatura das demais variantes *_Buf.
+ */
+static void EncryptECB(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv) {
+    (void)iv;
+    CHIMA_EncryptECB_Buf(pCtx, in, out, nblocks);
+}
+
+/**
+ * @brief ECB com a assinatura das demais variantes *_Buf.
+ */
+static void DecryptECB(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv) {
+    (void)iv;
+    CHIMA_DecryptECB_Buf(pCtx, in, out, nblocks);
+}
+
+/**
+ * @brief Escolhe a função em massa do modo.
+ *
+ * @param xMode    Modo de operação
+ * @param iDecrypt 1 para decifrar
+ * @return Função do modo ou NULL se o modo for inválido
+ */
+static BufFn Mode_Fn(CipherMode xMode, int iDecrypt) {
+    switch (xMode) {
+        case CIPHER_MODE_ECB: return iDecrypt ? DecryptECB : EncryptECB;
+        case CIPHER_MODE_CBC: return iDecrypt ? CHIMA_DecryptCBC_Buf : CHIMA_EncryptCBC_Buf;
+        case CIPHER_MODE_CFB: return iDecrypt ? CHIMA_DecryptCFB_Buf : CHIMA_EncryptCFB_Buf;
+        case CIPHER_MODE_OFB: return CHIMA_EncryptOFB_Buf;
+        case CIPHER_MODE_CTR: return CHIMA_EncryptCTR_Buf;
+        default:              return NULL;
+    }
+}
+
+/**
+ * @brief Pula segmentos vazios ou já consumidos.
+ */
+static void Cursor_Skip(IovCursor *pCur) {
+    while (pCur->pIov < pCur->pEnd && pCur->szOff == pCur->pIov->iov_len) {
+        pCur->pIov++;
+        pCur->szOff = 0;
+    }
+}
+
+/**
+ * @brief Bytes contíguos disponíveis a partir do cursor.
+ */
+static size_t Cursor_Avail(const IovCursor *pCur) {
+    return (pCur->pIov < pCur->pEnd) ? pCur->pIov->iov_len - pCur->szOff : 0;
+}
+
+/**
+ * @brief Endereço do próximo byte do cursor.
+ */
+static uint8_t *Cursor_Ptr(const IovCursor *pCur) {
+    return (uint8_t *)pCur->pIov->iov_base + pCur->szOff;
+}
+
+/**
+ * @brief Copia len bytes entre um buffer e a lista, avançando o cursor.
+ *
+ * @param pCur    Cursor
+ * @param buf     Buffer
+ * @param len     Quantidade de bytes (cabe no restante da lista)
+ * @param iToList 1 para gravar buf na lista, 0 para ler da lista
+ */
+static void Cursor_Copy(IovCursor *pCur, uint8_t *buf, size_t len, int iToList) {
+    size_t take;
+
+    while (len > 0) {
+        Cursor_Skip(pCur);
+        take = Cursor_Avail(pCur);
+        if (take > len)
+            take = len;
+        if (iToList)
+            memcpy(Cursor_Ptr(pCur), buf, take);
+        else
+            memcpy(buf, Cursor_Ptr(pCur), take);
+        pCur->szOff += take;
+        buf += take;
+        len -= take;
+    }
+}
+
+/**
+ * @brief Soma os tamanhos dos segmentos.
+ *
+ * @return Total em bytes ou (size_t)-1 se a lista for inválida
+ */
+static size_t Iov_Total(const struct iovec *pIov, int iCnt) {
+    size_t szTotal = 0;
+
+    if (iCnt < 0 || (iCnt > 0 && pIov == NULL))
+        return (size_t)-1;
+    for (int i = 0; i < iCnt; i++) {
+        if (pIov[i].iov_len > 0 && pIov[i].iov_base == NULL)
+            return (size_t)-1;
+        szTotal += pIov[i].iov_len;
+    }
+    return szTotal;
+}
+
+/**
+ * @brief Percorre as duas listas aplicando a função em massa do modo.
+ */
+static int Iov_Process(const CHIMA_Ctx *pCtx, CipherMode xMode, int iDecrypt,
+     const struct iovec *pIn, int iInCnt, const struct iovec *pOut, int iOutCnt, uint8_t *iv) {
+    BufFn pfnBuf = Mode_Fn(xMode, iDecrypt);
+    IovCursor xIn, xOut;
+    uint8_t block[16] = {0};
+    size_t szLeft, szOutTotal, szRun, nblocks;
+    uint32_t bs;
+
+    if (pCtx == NULL || pfnBuf == NULL || (xMode != CIPHER_MODE_ECB && iv == NULL))
+        return -1;
+    bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    szLeft = Iov_Total(pIn, iInCnt);
+    szOutTotal = Iov_Total(pOut, iOutCnt);
+    if (szLeft == (size_t)-1 || szOutTotal == (size_t)-1 || szOutTotal < szLeft)
+        return -1;
+    if ((xMode == CIPHER_MODE_ECB || xMode == CIPHER_MODE_CBC) && szLeft % bs != 0)
+        return -1;
+
+    xIn = (IovCursor){ pIn, pIn + iInCnt, 0 };
+    xOut = (IovCursor){ pOut, pOut + iOutCnt, 0 };
+
+    while (szLeft >= bs) {
+        Cursor_Skip(&xIn);
+        Cursor_Skip(&xOut);
+        szRun = Cursor_Avail(&xIn);
+        if (szRun > Cursor_Avail(&xOut))
+            szRun = Cursor_Avail(&xOut);
+        nblocks = szRun / bs;
+
+        if (nblocks > 0) {
+            pfnBuf(pCtx, Cursor_Ptr(&xIn), Cursor_Ptr(&xOut), nblocks, iv);
+            xIn.szOff += nblocks * bs;
+            xOut.szOff += nblocks * bs;
+            szLeft -= nblocks * bs;
+        } else {
+            // Bloco dividido entre segmentos
+            Cursor_Copy(&xIn, block, bs, 0);
+            pfnBuf(pCtx, block, block, 1, iv);
+            Cursor_Copy(&xOut, block, bs, 1);
+            szLeft -= bs;
+        }
+    }
+
+    // Bloco final incompleto (só CFB/OFB/CTR): os primeiros bytes do
+    // resultado não dependem do restante do bloco
+    if (szLeft > 0) {
+        memset(block, 0, sizeof(block));
+        Cursor_Copy(&xIn, block, szLeft, 0);
+        pfnBuf(pCtx, block, block, 1, iv);
+        Cursor_Copy(&xOut, block, szLeft, 1);
+    }
+
+    SecureZero(block, sizeof(block));
+    return 0;
+}
+
+/**
+ * @brief Cifra blocos no próprio buffer.
+ *
+ * @param pCtx    Contexto com as chaves
+ * @param xMode   Modo de operação
+ * @param buf     Dados claros; recebe os cifrados
+ * @param nblocks Quantidade de blocos
+ * @param iv      IV ou contador (ignorado em ECB); atualizado como em *_Buf
+ * @return 0 em caso de sucesso, -1 em erro
+ */
+int CHIMA_EncryptInPlace(const CHIMA_Ctx *pCtx, CipherMode xMode, uint8_t *buf, size_t nblocks, uint8_t *iv) {
+    BufFn pfnBuf = Mode_Fn(xMode, 0);
+
+    if (pCtx == NULL || pfnBuf == NULL || (buf == NULL && nblocks > 0) || (xMode != CIPHER_MODE_ECB && iv == NULL))
+        return -1;
+    pfnBuf(pCtx, buf, buf, nblocks, iv);
+    return 0;
+}
+
+/**
+ * @brief Decifra blocos no próprio buffer.
+ *
+ * @param pCtx    Contexto com as chaves
+ * @param xMode   Modo de operação
+ * @param buf     Dados cifrados; recebe os claros
+ * @param nblocks Quantidade de blocos
+ * @param iv      IV ou contador (ignorado em ECB); atualizado como em *_Buf
+ * @return 0 em caso de sucesso, -1 em erro
+ */
+int CHIMA_DecryptInPlace(const CHIMA_Ctx *pCtx, CipherMode xMode, uint8_t *buf, size_t nblocks, uint8_t *iv) {
+    BufFn pfnBuf = Mode_Fn(xMode, 1);
+
+    if (pCtx == NULL || pfnBuf == NULL || (buf == NULL && nblocks > 0) || (xMode != CIPHER_MODE_ECB && iv == NULL))
+        return -1;
+    pfnBuf(pCtx, buf, buf, nblocks, iv);
+    return 0;
+}
+
+/**
+ * @brief Cifra os dados de uma lista de segmentos.
+ *
+ * @param pCtx    Contexto com as chaves
+ * @param xMode   Modo de operação
+ * @param pIn     Segmentos de entrada
+ * @param iInCnt  Quantidade de segmentos de entrada
+ * @param pOut    Segmentos de saída (podem ser os de entrada)
+ * @param iOutCnt Quantidade de segmentos de saída
+ * @param iv      IV ou contador (ignorado em ECB); atualizado como em *_Buf
+ * @return 0 em caso de sucesso, -1 em erro
+ */
+int CHIMA_EncryptIov(const CHIMA_Ctx *pCtx, CipherMode xMode,
+     const struct iovec *pIn, int iInCnt, const struct iovec *pOut, int iOutCnt, uint8_t *iv) {
+    return Iov_Process(pCtx, xMode, 0, pIn, iInCnt, pOut, iOutCnt, iv);
+}
+
+/**
+ * @brief Decifra os dados de uma lista de segmentos.
+ *
+ * @param pCtx    Contexto com as chaves
+ * @param xMode   Modo de operação
+ * @param pIn     Segmentos cifrados
+ * @param iInCnt  Quantidade de segmentos de entrada
+ * @param pOut    Segmentos de saída (podem ser os de entrada)
+ * @param iOutCnt Quantidade de segmentos de saída
+ * @param iv      IV ou contador (ignorado em ECB); atualizado como em *_Buf
+ * @return 0 em caso de sucesso, -1 em erro
+ */
+int CHIMA_DecryptIov(const CHIMA_Ctx *pCtx, CipherMode xMode,
+     const struct iovec *pIn, int iInCnt, const struct iovec *pOut, int iOutCnt, uint8_t *iv) {
+    return Iov_Process(pCtx, xMode, 1, pIn, iInCnt, pOut, iOutCnt, iv);
+}
@@ -0,0 +1,56 @@
+/**
+ * @file chima_iov.h
+ * @author
+ * @brief Cifragem no próprio buffer e sobre listas de segmentos (iovec).
+ * @version
+ * @date 2025-06-13
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef CHIMA_IOV_H
+#define CHIMA_IOV_H
+
+
+// INCLUSÕES //
+
+#include "chima_crypto.h"
+#include <sys/uio.h>
+
+
+// PROTÓTIPOS DE FUNÇÃO //
+
+/*
+ * Cifram ou decifram nblocks blocos sobre o próprio buffer, sem cópia
+ * intermediária. O iv (ignorado em ECB) é atualizado como em *_Buf.
+ * Retornam 0 em caso de sucesso e -1 se os parâmetros forem inválidos.
+ */
+
+int CHIMA_EncryptInPlace(const CHIMA_Ctx *pCtx, CipherMode xMode, uint8_t *buf, size_t nblocks, uint8_t *iv);
+int CHIMA_DecryptInPlace(const CHIMA_Ctx *pCtx, CipherMode xMode, uint8_t *buf, size_t nblocks, uint8_t *iv);
+
+/*
+ * Cifram ou decifram os bytes da lista de entrada, na ordem, gravando-os
+ * na lista de saída, que pode ter outra segmentação mas precisa comportar
+ * o mesmo total. Os trechos de blocos inteiros contidos em um segmento de
+ * cada lista vão direto para as funções em massa; só os blocos divididos
+ * entre segmentos passam por um buffer de um bloco.
+ *
+ * As duas listas podem ser a mesma (cifragem no próprio buffer); fora
+ * isso, os segmentos de entrada e saída não podem se sobrepor.
+ *
+ * Em ECB e CBC o total precisa ser múltiplo do bloco. Em CFB, OFB e CTR
+ * um bloco final incompleto é aceito e encerra o fluxo: depois dele o iv
+ * não serve para continuar em outra chamada.
+ *
+ * Retornam 0 em caso de sucesso e -1 se os parâmetros forem inválidos.
+ */
+
+int CHIMA_EncryptIov(const CHIMA_Ctx *pCtx, CipherMode xMode,
+     const struct iovec *pIn, int iInCnt, const struct iovec *pOut, int iOutCnt, uint8_t *iv);
+int CHIMA_DecryptIov(const CHIMA_Ctx *pCtx, CipherMode xMode,
+     const struct iovec *pIn, int iInCnt, const struct iovec *pOut, int iOutCnt, uint8_t *iv);
+
+
+#endif /* CHIMA_IOV_H */
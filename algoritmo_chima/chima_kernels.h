@@ -0,0 +1,202 @@
+/**
+ * @file chima_kernels.h
+ * @author
+ * @brief Interface interna dos núcleos de cifragem e da tabela de despacho.
+ * @version
+ * @date 2025-06-13
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef CHIMA_KERNELS_H
+#define CHIMA_KERNELS_H
+
+
+// INCLUSÕES //
+
+#include "chima_crypto.h"
+#include "chima_aead.h"
+#include "chima_dispatch.h"
+
+
+// DEFINIÇÕES //
+
+/** Blocos processados em paralelo pelo núcleo bitsliced */
+#if defined(__GNUC__)
+#define CHIMA_BITSLICE_LANES 128
+#else
+#define CHIMA_BITSLICE_LANES 64
+#endif
+/** Blocos processados em paralelo pelo núcleo AES-NI */
+#define CHIMA_AESNI_LANES  4
+/** Blocos processados em paralelo pelo núcleo AVX2 */
+#define CHIMA_AVX2_LANES   8
+/** Blocos processados em paralelo pelo núcleo AVX-512 */
+#define CHIMA_AVX512_LANES 16
+/**
+ * Lote mínimo do núcleo AVX-512 no modo automático: abaixo disso o preparo
+ * das constantes de rodada a cada chamada não compensa e o bitsliced é
+ * mais rápido (medido com os lotes de 128 blocos de CTR/OFB)
+ */
+#define CHIMA_AVX512_MIN_BLOCKS 256
+
+/** Máximo de núcleos encadeados nas funções em massa */
+#define CHIMA_MAX_KERNELS  4
+
+/*
+ * Em x86-64 com GCC/Clang todos os núcleos são compilados, cada função
+ * com o atributo target das extensões que usa, e o despacho em tempo de
+ * execução escolhe entre eles. Nos demais alvos só o código portátil
+ * existe.
+ */
+#if defined(__GNUC__) && defined(__x86_64__)
+#define CHIMA_X86_DISPATCH 1
+#define CHIMA_HAVE_AESNI   1
+#define CHIMA_HAVE_AVX2    1
+#if defined(__clang__) || __GNUC__ >= 8
+#define CHIMA_HAVE_AVX512  1
+#endif
+#define CHIMA_TARGET(x) __attribute__((target(x)))
+#else
+#define CHIMA_TARGET(x)
+#endif
+
+/** Extensões exigidas pelo núcleo AES-NI e pelas rodadas aceleradas */
+#define CHIMA_CPU_FAST_ROUNDS (CHIMA_CPU_BMI2 | CHIMA_CPU_SSSE3 | CHIMA_CPU_AESNI)
+
+
+// TIPOS //
+
+/** Núcleo que processa blocos independentes (ver protótipos abaixo) */
+typedef size_t (*CHIMA_BlocksFn)(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t n);
+
+/**
+ * Núcleo em que cada bloco usa o seu contexto; os contextos de uma chamada
+ * têm o mesmo xSize e ui32NumRounds.
+ */
+typedef size_t (*CHIMA_MultiKeyFn)(const CHIMA_Ctx *const *apCtx, const uint8_t *in, uint8_t *out, size_t n);
+
+/** Rede Feistel de um bloco com número de rodadas explícito */
+typedef void (*CHIMA_RoundsFn)(uint32_t *block, const uint32_t *roundKeys, BlockCipherSize mode, uint32_t rounds);
+
+/**
+ * @brief Implementações escolhidas para o processador em uso.
+ */
+typedef struct {
+    uint32_t        ui32Features;                                  /**< Extensões em uso (CHIMA_CpuFeature) */
+    CHIMA_Backend   xBackend;                                      /**< Backend principal */
+    uint64_t      (*pfnApplySBox)(uint64_t x, int num_bytes);      /**< ApplySBoxAES */
+    uint64_t      (*pfnPermute)(uint64_t data, uint64_t mask, int num_bits); /**< PermuteWithMask */
+    CHIMA_RoundsFn  pfnEncryptRounds;                              /**< Rede de cifragem de um bloco */
+    CHIMA_RoundsFn  pfnDecryptRounds;                              /**< Rede de decifração de um bloco */
+    CHIMA_BlocksFn  apfnEncryptBlocks[CHIMA_MAX_KERNELS + 1];      /**< Núcleos em massa, terminados em NULL */
+    CHIMA_BlocksFn  apfnDecryptBlocks[CHIMA_MAX_KERNELS + 1];      /**< Núcleos em massa, terminados em NULL */
+    CHIMA_MultiKeyFn pfnEncryptMultiKey;                          /**< Núcleo de cifragem com várias chaves (ou NULL) */
+    CHIMA_MultiKeyFn pfnDecryptMultiKey;                          /**< Núcleo de decifração com várias chaves (ou NULL) */
+    void          (*pfnLesamntaCompress)(uint32_t *pui32Hash, const uint32_t *pui32Message); /**< Compressão do Lesamnta-LW */
+    void          (*pfnGhash)(uint8_t *pucX, const CHIMA_GhashKey *pKey, const uint8_t *data, size_t nblocks); /**< GHASH de blocos de 16 bytes */
+} CHIMA_Dispatch;
+
+
+// FUNÇÕES EM LINHA //
+
+#if defined(CHIMA_X86_DISPATCH)
+#include <immintrin.h>
+
+/**
+ * @brief Aplica a S-Box do AES aos 16 bytes de um registrador.
+ *
+ * AESENCLAST com chave nula aplica ShiftRows e SubBytes; o pshufb fixo
+ * desfaz o ShiftRows e cada byte volta à sua posição.
+ *
+ * @param x Bytes de entrada
+ * @return Bytes substituídos
+ */
+static inline CHIMA_TARGET("aes,ssse3") __m128i CHIMA_AESNI_SBox(__m128i x) {
+    const __m128i invShiftRows = _mm_setr_epi8(0, 13, 10, 7, 4, 1, 14, 11, 8, 5, 2, 15, 12, 9, 6, 3);
+    return _mm_shuffle_epi8(_mm_aesenclast_si128(x, _mm_setzero_si128()), invShiftRows);
+}
+
+/**
+ * @brief Permuta bits de acordo com a máscara usando PDEP (BMI2).
+ *
+ * As posições com bit 0 na máscara recebem, em ordem, os bits baixos do
+ * dado; as posições com bit 1 recebem os bits altos em ordem invertida.
+ * Cada metade é um único depósito de bits.
+ *
+ * @param data     Valor original
+ * @param mask     Máscara de permutação
+ * @param num_bits Número de bits válidos (1 a 64)
+ * @return Valor permutado
+ */
+static inline CHIMA_TARGET("bmi2") uint64_t CHIMA_BMI2_Permute(uint64_t data, uint64_t mask, int num_bits) {
+    uint64_t valid = (num_bits >= 64) ? ~0ULL : ((1ULL << num_bits) - 1);
+    uint64_t reversed = data;
+
+    reversed = ((reversed >> 1) & 0x5555555555555555ULL) | ((reversed & 0x5555555555555555ULL) << 1);
+    reversed = ((reversed >> 2) & 0x3333333333333333ULL) | ((reversed & 0x3333333333333333ULL) << 2);
+    reversed = ((reversed >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((reversed & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    reversed = __builtin_bswap64(reversed) >> (64 - num_bits);
+
+    return _pdep_u64(data, ~mask & valid) | _pdep_u64(reversed, mask & valid);
+}
+#endif
+
+
+// PROTÓTIPOS DE FUNÇÃO //
+
+/**
+ * @brief Tabela de despacho, preenchida no primeiro uso.
+ *
+ * @return Implementações escolhidas
+ */
+const CHIMA_Dispatch *CHIMA_GetDispatch(void);
+
+/*
+ * Cada módulo escolhe as próprias variantes a partir de ui32Features já
+ * preenchido; chamadas uma vez durante CHIMA_DispatchInit.
+ */
+void CHIMA_BindCrypto(CHIMA_Dispatch *pDispatch);
+void CHIMA_BindLesamnta(CHIMA_Dispatch *pDispatch);
+void CHIMA_BindGhash(CHIMA_Dispatch *pDispatch);
+
+/**
+ * @brief Pré-calcula a chave do GHASH a partir de H.
+ *
+ * @param pKey Chave do GHASH
+ * @param pucH H (16 bytes)
+ */
+void CHIMA_GhashSetKey(CHIMA_GhashKey *pKey, const uint8_t *pucH);
+
+/*
+ * Os núcleos processam os primeiros blocos de in em grupos do seu número
+ * de vias e retornam quantos blocos trataram; o restante fica para o
+ * caminho escalar. out pode ser igual a in. A saída é idêntica à de
+ * FeistelEncrypt/FeistelDecrypt com as chaves e rodadas do contexto.
+ * Os núcleos x86 só podem ser chamados se o processador tiver as
+ * extensões correspondentes.
+ */
+
+size_t CHIMA_BITSLICE_EncryptBlocks(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t n);
+size_t CHIMA_BITSLICE_DecryptBlocks(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t n);
+
+#if defined(CHIMA_HAVE_AESNI)
+size_t CHIMA_AESNI_EncryptBlocks(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t n);
+size_t CHIMA_AESNI_DecryptBlocks(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t n);
+size_t CHIMA_AESNI_EncryptMultiKey(const CHIMA_Ctx *const *apCtx, const uint8_t *in, uint8_t *out, size_t n);
+size_t CHIMA_AESNI_DecryptMultiKey(const CHIMA_Ctx *const *apCtx, const uint8_t *in, uint8_t *out, size_t n);
+#endif
+
+#if defined(CHIMA_HAVE_AVX2)
+size_t CHIMA_AVX2_EncryptBlocks(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t n);
+size_t CHIMA_AVX2_DecryptBlocks(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t n);
+#endif
+
+#if defined(CHIMA_HAVE_AVX512)
+size_t CHIMA_AVX512_EncryptBlocks(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t n);
+size_t CHIMA_AVX512_DecryptBlocks(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t n);
+#endif
+
+
+#endif /* CHIMA_KERNELS_H */
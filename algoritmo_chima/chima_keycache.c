@@ -0,0 +1,353 @@
+/**
+ * @file chima_keycache.c
+ * @author
+ * @brief Cache LRU de chaves expandidas para as funções sem contexto.
+ * @version
+ * @date 2025-06-13
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * As entradas ficam em um vetor alocado de uma vez pelo orçamento, com uma
+ * tabela de espalhamento encadeada para a busca e uma lista duplamente
+ * encadeada em ordem de uso para o descarte. Uma única trava protege tudo;
+ * a expansão de uma chave ausente acontece fora dela. A comparação das
+ * chaves não depende da posição do primeiro byte diferente.
+ */
+
+
+// INCLUSÕES //
+
+#include "chima_keycache.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+// DEFINIÇÕES //
+
+/** Bytes da chave usada como índice */
+#define KEYCACHE_KEY_BYTES 16
+
+
+// TIPOS //
+
+/**
+ * @brief Uma chave guardada.
+ */
+typedef struct KeyCacheEntry {
+    uint8_t               aucKey[KEYCACHE_KEY_BYTES];              /**< Chave bruta */
+    uint32_t              aui32RoundKeys[CHIMA_ROUND_KEY_WORDS];   /**< Chaves de rodada */
+    struct KeyCacheEntry *pHashNext;                               /**< Próxima do mesmo balde */
+    struct KeyCacheEntry *pNewer;                                  /**< Vizinha usada depois */
+    struct KeyCacheEntry *pOlder;                                  /**< Vizinha usada antes */
+} KeyCacheEntry;
+
+/**
+ * @brief Estado do cache; os campos são protegidos por xLock.
+ */
+typedef struct {
+    pthread_mutex_t  xLock;         /**< Protege os campos abaixo */
+    KeyCacheEntry   *pEntries;      /**< Vetor de entradas */
+    KeyCacheEntry  **ppBuckets;     /**< Baldes da tabela de espalhamento */
+    size_t           szBuckets;     /**< Quantidade de baldes (potência de 2) */
+    size_t           szBudget;      /**< Orçamento em bytes */
+    size_t           szCapacity;    /**< Entradas no vetor */
+    size_t           szUsed;        /**< Entradas ocupadas */
+    KeyCacheEntry   *pNewest;       /**< Usada por último */
+    KeyCacheEntry   *pOldest;       /**< Próxima a ser descartada */
+    uint64_t         ui64Hits;
+    uint64_t         ui64Misses;
+    uint64_t         ui64Evictions;
+} KeyCache;
+
+
+// VARIÁVEIS GLOBAIS //
+
+static KeyCache g_xCache = { .xLock = PTHREAD_MUTEX_INITIALIZER };
+/** Atalho sem trava para o cache desligado */
+static atomic_int g_iEnabled;
+static pthread_once_t g_xEnvOnce = PTHREAD_ONCE_INIT;
+
+
+// FUNÇÕES //
+
+/**
+ * @brief Balde de uma chave (mistura das duas metades de 64 bits).
+ */
+static size_t Key_Hash(const uint8_t *key, size_t szBuckets) {
+    uint64_t a, b;
+
+    memcpy(&a, key, 8);
+    memcpy(&b, key + 8, 8);
+    a ^= b * 0x9E3779B97F4A7C15ULL;
+    a ^= a >> 31;
+    a *= 0xBF58476D1CE4E5B9ULL;
+    a ^= a >> 29;
+    return (size_t)a & (szBuckets - 1);
+}
+
+/**
+ * @brief Compara duas chaves sem desvio pelo conteúdo.
+ *
+ * @return 1 se iguais
+ */
+static int Key_Equal(const uint8_t *a, const uint8_t *b) {
+    uint8_t diff = 0;
+
+    for (int i = 0; i < KEYCACHE_KEY_BYTES; i++)
+        diff |= (uint8_t)(a[i] ^ b[i]);
+    return diff == 0;
+}
+
+/**
+ * @brief Retira a entrada da lista de uso.
+ */
+static void Lru_Unlink(KeyCache *pCache, KeyCacheEntry *pEntry) {
+    if (pEntry->pNewer != NULL)
+        pEntry->pNewer->pOlder = pEntry->pOlder;
+    else
+        pCache->pNewest = pEntry->pOlder;
+    if (pEntry->pOlder != NULL)
+        pEntry->pOlder->pNewer = pEntry->pNewer;
+    else
+        pCache->pOldest = pEntry->pNewer;
+}
+
+/**
+ * @brief Coloca a entrada como a usada por último.
+ */
+static void Lru_PushNewest(KeyCache *pCache, KeyCacheEntry *pEntry) {
+    pEntry->pNewer = NULL;
+    pEntry->pOlder = pCache->pNewest;
+    if (pCache->pNewest != NULL)
+        pCache->pNewest->pNewer = pEntry;
+    else
+        pCache->pOldest = pEntry;
+    pCache->pNewest = pEntry;
+}
+
+/**
+ * @brief Procura a entrada de uma chave; a trava deve estar tomada.
+ */
+static KeyCacheEntry *Cache_Find(const KeyCache *pCache, const uint8_t *key) {
+    KeyCacheEntry *pEntry = pCache->ppBuckets[Key_Hash(key, pCache->szBuckets)];
+
+    for (; pEntry != NULL; pEntry = pEntry->pHashNext)
+        if (Key_Equal(pEntry->aucKey, key))
+            return pEntry;
+    return NULL;
+}
+
+/**
+ * @brief Retira a entrada do seu balde; a trava deve estar tomada.
+ */
+static void Hash_Unlink(KeyCache *pCache, KeyCacheEntry *pEntry) {
+    KeyCacheEntry **ppLink = &pCache->ppBuckets[Key_Hash(pEntry->aucKey, pCache->szBuckets)];
+
+    while (*ppLink != pEntry)
+        ppLink = &(*ppLink)->pHashNext;
+    *ppLink = pEntry->pHashNext;
+}
+
+/**
+ * @brief Apaga e libera as entradas; a trava deve estar tomada.
+ */
+static void Cache_Release(KeyCache *pCache) {
+    if (pCache->pEntries != NULL) {
+        SecureZero(pCache->pEntries, pCache->szCapacity * sizeof(KeyCacheEntry));
+        free(pCache->pEntries);
+    }
+    free(pCache->ppBuckets);
+    pCache->pEntries = NULL;
+    pCache->ppBuckets = NULL;
+    pCache->szBuckets = 0;
+    pCache->szCapacity = 0;
+    pCache->szUsed = 0;
+    pCache->pNewest = NULL;
+    pCache->pOldest = NULL;
+}
+
+/**
+ * @brief Aloca o cache para o orçamento; a trava deve estar tomada.
+ *
+ * Cada entrada custa a própria estrutura e até dois ponteiros de balde.
+ */
+static int Cache_Allocate(KeyCache *pCache, size_t szBytes) {
+    size_t szCapacity = szBytes / (sizeof(KeyCacheEntry) + 2 * sizeof(KeyCacheEntry *));
+    size_t szBuckets = 1;
+
+    pCache->szBudget = 0;
+    if (szCapacity == 0)
+        return 0;
+    while (szBuckets < szCapacity)
+        szBuckets <<= 1;
+
+    pCache->pEntries = (KeyCacheEntry *)calloc(szCapacity, sizeof(KeyCacheEntry));
+    pCache->ppBuckets = (KeyCacheEntry **)calloc(szBuckets, sizeof(KeyCacheEntry *));
+    if (pCache->pEntries == NULL || pCache->ppBuckets == NULL) {
+        Cache_Release(pCache);
+        return -1;
+    }
+    pCache->szCapacity = szCapacity;
+    pCache->szBuckets = szBuckets;
+    pCache->szBudget = szBytes;
+    return 0;
+}
+
+/**
+ * @brief Aplica o orçamento da variável de ambiente, uma única vez.
+ */
+static void KeyCache_InitEnv(void) {
+    const char *pszValue = getenv(CHIMA_KEYCACHE_ENV);
+    char *pszEnd;
+    unsigned long long ullBytes;
+
+    if (pszValue == NULL || *pszValue == '\0')
+        return;
+    ullBytes = strtoull(pszValue, &pszEnd, 10);
+    if (*pszEnd != '\0' || ullBytes > SIZE_MAX)
+        return;
+
+    pthread_mutex_lock(&g_xCache.xLock);
+    if (Cache_Allocate(&g_xCache, (size_t)ullBytes) == 0 && g_xCache.szCapacity > 0)
+        atomic_store(&g_iEnabled, 1);
+    pthread_mutex_unlock(&g_xCache.xLock);
+}
+
+/**
+ * @brief Define o orçamento de memória do cache.
+ *
+ * @param szBytes Bytes para o cache (0 desliga)
+ * @return 0 em caso de sucesso, -1 se faltar memória
+ */
+int CHIMA_KeyCacheSetBudget(size_t szBytes) {
+    int iRet;
+
+    pthread_once(&g_xEnvOnce, KeyCache_InitEnv);
+    pthread_mutex_lock(&g_xCache.xLock);
+    atomic_store(&g_iEnabled, 0);
+    Cache_Release(&g_xCache);
+    iRet = Cache_Allocate(&g_xCache, szBytes);
+    if (g_xCache.szCapacity > 0)
+        atomic_store(&g_iEnabled, 1);
+    pthread_mutex_unlock(&g_xCache.xLock);
+    return iRet;
+}
+
+/**
+ * @brief Apaga todas as chaves guardadas, mantendo o orçamento.
+ */
+void CHIMA_KeyCacheClear(void) {
+    pthread_once(&g_xEnvOnce, KeyCache_InitEnv);
+    pthread_mutex_lock(&g_xCache.xLock);
+    if (g_xCache.pEntries != NULL) {
+        SecureZero(g_xCache.pEntries, g_xCache.szCapacity * sizeof(KeyCacheEntry));
+        memset(g_xCache.ppBuckets, 0, g_xCache.szBuckets * sizeof(KeyCacheEntry *));
+    }
+    g_xCache.szUsed = 0;
+    g_xCache.pNewest = NULL;
+    g_xCache.pOldest = NULL;
+    pthread_mutex_unlock(&g_xCache.xLock);
+}
+
+/**
+ * @brief Lê as estatísticas do cache.
+ *
+ * @param pStats Recebe as estatísticas
+ */
+void CHIMA_KeyCacheGetStats(CHIMA_KeyCacheStats *pStats) {
+    if (pStats == NULL)
+        return;
+
+    pthread_once(&g_xEnvOnce, KeyCache_InitEnv);
+    pthread_mutex_lock(&g_xCache.xLock);
+    pStats->szBudget = g_xCache.szBudget;
+    pStats->szCapacity = g_xCache.szCapacity;
+    pStats->szEntries = g_xCache.szUsed;
+    pStats->ui64Hits = g_xCache.ui64Hits;
+    pStats->ui64Misses = g_xCache.ui64Misses;
+    pStats->ui64Evictions = g_xCache.ui64Evictions;
+    pthread_mutex_unlock(&g_xCache.xLock);
+}
+
+/**
+ * @brief Procura as chaves de rodada de uma chave.
+ *
+ * @param key            Chave de 128 bits
+ * @param pui32RoundKeys Recebe as chaves de rodada se encontrada
+ * @return 0 se encontrada, -1 se ausente ou cache desligado
+ */
+int CHIMA_KeyCacheLookup(const uint8_t *key, uint32_t *pui32RoundKeys) {
+    KeyCacheEntry *pEntry;
+
+    pthread_once(&g_xEnvOnce, KeyCache_InitEnv);
+    if (!atomic_load_explicit(&g_iEnabled, memory_order_relaxed))
+        return -1;
+
+    pthread_mutex_lock(&g_xCache.xLock);
+    if (g_xCache.szCapacity == 0) {
+        pthread_mutex_unlock(&g_xCache.xLock);
+        return -1;
+    }
+    pEntry = Cache_Find(&g_xCache, key);
+    if (pEntry == NULL) {
+        g_xCache.ui64Misses++;
+        pthread_mutex_unlock(&g_xCache.xLock);
+        return -1;
+    }
+    g_xCache.ui64Hits++;
+    if (pEntry != g_xCache.pNewest) {
+        Lru_Unlink(&g_xCache, pEntry);
+        Lru_PushNewest(&g_xCache, pEntry);
+    }
+    memcpy(pui32RoundKeys, pEntry->aui32RoundKeys, sizeof(pEntry->aui32RoundKeys));
+    pthread_mutex_unlock(&g_xCache.xLock);
+    return 0;
+}
+
+/**
+ * @brief Guarda as chaves de rodada de uma chave.
+ *
+ * Se outra thread já guardou a mesma chave, só a marca como usada.
+ *
+ * @param key            Chave de 128 bits
+ * @param pui32RoundKeys Chaves de rodada
+ */
+void CHIMA_KeyCacheInsert(const uint8_t *key, const uint32_t *pui32RoundKeys) {
+    KeyCacheEntry *pEntry;
+    size_t szBucket;
+
+    pthread_once(&g_xEnvOnce, KeyCache_InitEnv);
+    if (!atomic_load_explicit(&g_iEnabled, memory_order_relaxed))
+        return;
+
+    pthread_mutex_lock(&g_xCache.xLock);
+    if (g_xCache.szCapacity == 0) {
+        pthread_mutex_unlock(&g_xCache.xLock);
+        return;
+    }
+
+    pEntry = Cache_Find(&g_xCache, key);
+    if (pEntry != NULL) {
+        Lru_Unlink(&g_xCache, pEntry);
+    } else {
+        if (g_xCache.szUsed < g_xCache.szCapacity) {
+            pEntry = &g_xCache.pEntries[g_xCache.szUsed++];
+        } else {
+            // Descarta a menos usada, apagando a chave e a expansão
+            pEntry = g_xCache.pOldest;
+            Lru_Unlink(&g_xCache, pEntry);
+            Hash_Unlink(&g_xCache, pEntry);
+            SecureZero(pEntry, sizeof(*pEntry));
+            g_xCache.ui64Evictions++;
+        }
+        memcpy(pEntry->aucKey, key, KEYCACHE_KEY_BYTES);
+        memcpy(pEntry->aui32RoundKeys, pui32RoundKeys, sizeof(pEntry->aui32RoundKeys));
+        szBucket = Key_Hash(key, g_xCache.szBuckets);
+        pEntry->pHashNext = g_xCache.ppBuckets[szBucket];
+        g_xCache.ppBuckets[szBucket] = pEntry;
+    }
+    Lru_PushNewest(&g_xCache, pEntry);
+    pthread_mutex_unlock(&g_xCache.xLock);
+}
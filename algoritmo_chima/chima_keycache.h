@@ -0,0 +1,98 @@
+/**
+ * @file chima_keycache.h
+ * @author
+ * @brief Cache LRU de chaves expandidas para as funções sem contexto.
+ * @version
+ * @date 2025-06-13
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef CHIMA_KEYCACHE_H
+#define CHIMA_KEYCACHE_H
+
+
+// INCLUSÕES //
+
+#include "chima_crypto.h"
+
+
+// DEFINIÇÕES //
+
+/** Variável de ambiente com o orçamento inicial do cache, em bytes */
+#define CHIMA_KEYCACHE_ENV "CHIMA_KEYCACHE"
+
+
+// TIPOS //
+
+/**
+ * @brief Estatísticas do cache.
+ */
+typedef struct {
+    size_t   szBudget;      /**< Orçamento de memória, em bytes (0 = desligado) */
+    size_t   szCapacity;    /**< Chaves que cabem no orçamento */
+    size_t   szEntries;     /**< Chaves guardadas */
+    uint64_t ui64Hits;      /**< Consultas atendidas pelo cache */
+    uint64_t ui64Misses;    /**< Consultas que expandiram a chave */
+    uint64_t ui64Evictions; /**< Chaves descartadas por falta de espaço */
+} CHIMA_KeyCacheStats;
+
+
+// PROTÓTIPOS DE FUNÇÃO //
+
+/*
+ * CHIMA_Cipher/CHIMA_Decipher e as funções sem contexto (CHIMA_EncryptECB
+ * etc.) recebem a chave bruta e a expandiam a cada chamada. Com o cache
+ * ligado, as chaves de rodada de cada chave de 16 bytes ficam guardadas e
+ * as chamadas seguintes só as copiam. Quando o orçamento se esgota, a
+ * chave usada há mais tempo é descartada, e sua cópia e sua expansão são
+ * apagadas da memória.
+ *
+ * O cache começa desligado, ou com o orçamento em bytes da variável
+ * CHIMA_KEYCACHE, lida no primeiro uso. Todas as funções são seguras entre
+ * threads.
+ */
+
+/**
+ * @brief Define o orçamento de memória do cache.
+ *
+ * As chaves guardadas são apagadas; os contadores continuam.
+ *
+ * @param szBytes Bytes para o cache (0 desliga; orçamentos menores que uma
+ *                entrada também)
+ * @return 0 em caso de sucesso, -1 se faltar memória (cache desligado)
+ */
+int CHIMA_KeyCacheSetBudget(size_t szBytes);
+
+/**
+ * @brief Apaga todas as chaves guardadas, mantendo o orçamento.
+ */
+void CHIMA_KeyCacheClear(void);
+
+/**
+ * @brief Lê as estatísticas do cache.
+ *
+ * @param pStats Recebe as estatísticas
+ */
+void CHIMA_KeyCacheGetStats(CHIMA_KeyCacheStats *pStats);
+
+/**
+ * @brief Procura as chaves de rodada de uma chave.
+ *
+ * @param key            Chave de 128 bits
+ * @param pui32RoundKeys Recebe CHIMA_ROUND_KEY_WORDS palavras se encontrada
+ * @return 0 se encontrada, -1 se ausente ou cache desligado
+ */
+int CHIMA_KeyCacheLookup(const uint8_t *key, uint32_t *pui32RoundKeys);
+
+/**
+ * @brief Guarda as chaves de rodada de uma chave, descartando a menos usada.
+ *
+ * @param key            Chave de 128 bits
+ * @param pui32RoundKeys CHIMA_ROUND_KEY_WORDS palavras
+ */
+void CHIMA_KeyCacheInsert(const uint8_t *key, const uint32_t *pui32RoundKeys);
+
+
+#endif /* CHIMA_KEYCACHE_H */
@@ -0,0 +1,296 @@
+/**
+ * @file chima_keystream.c
+ * @author
+ * @brief Fluxo de chave OFB/CTR pré-calculado em segundo plano.
+ * @version
+ * @date 2025-06-13
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Uma thread geradora preenche um buffer circular com o fluxo de chave, em
+ * partes de CHIMA_KS_CHUNK bytes, enquanto houver espaço livre; o
+ * consumidor só combina os dados com o fluxo já pronto. O buffer tem um
+ * produtor e um consumidor: as posições de escrita e leitura são contadores
+ * atômicos de bytes que só crescem, e a trava só é tomada quando um dos
+ * lados precisa dormir ou acordar o outro.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+
+// INCLUSÕES //
+
+#include "chima_keystream.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+// TIPOS //
+
+/**
+ * @brief Estado do gerador.
+ *
+ * ui64Head só é escrito pela thread geradora e ui64Tail só pelo
+ * consumidor. Os indicadores de espera, junto com as posições, seguem a
+ * ordem sequencial: quem vai dormir publica o indicador e relê a posição
+ * do outro lado, e quem avança a posição relê o indicador, então ao menos
+ * um dos dois percebe o outro.
+ */
+struct CHIMA_Keystream {
+    const CHIMA_Ctx  *pCtx;               /**< Contexto com as chaves */
+    CipherMode        xMode;              /**< CIPHER_MODE_OFB ou CIPHER_MODE_CTR */
+    uint8_t           aucIv[16];          /**< Próximo IV/contador da geradora */
+    uint8_t          *pucRing;            /**< Buffer circular */
+    size_t            szCapacity;         /**< Tamanho do buffer, em bytes */
+    _Atomic uint64_t  ui64Head;           /**< Bytes gerados desde o início */
+    _Atomic uint64_t  ui64Tail;           /**< Bytes consumidos desde o início */
+    atomic_int        iProducerWaiting;   /**< Geradora dormindo por espaço */
+    atomic_int        iConsumerWaiting;   /**< Consumidor dormindo por fluxo */
+    atomic_int        iStop;              /**< Pede o encerramento da geradora */
+    pthread_mutex_t   xLock;              /**< Protege as esperas */
+    pthread_cond_t    xSpace;             /**< Sinaliza espaço livre */
+    pthread_cond_t    xData;              /**< Sinaliza fluxo pronto */
+    pthread_t         xThread;            /**< Thread geradora */
+    _Atomic uint64_t  ui64Refills;        /**< Estatísticas (ver CHIMA_KeystreamStats) */
+    _Atomic uint64_t  ui64RefillNsLast;
+    _Atomic uint64_t  ui64RefillNsMax;
+    _Atomic uint64_t  ui64RefillNsTotal;
+    _Atomic uint64_t  ui64Stalls;
+    _Atomic uint64_t  ui64StallNsTotal;
+};
+
+
+// FUNÇÕES //
+
+/**
+ * @brief Relógio monotônico em nanossegundos.
+ */
+static uint64_t Now_Ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Gera a próxima parte do fluxo na posição de escrita.
+ *
+ * O buffer tem tamanho múltiplo de CHIMA_KS_CHUNK, então a parte nunca dá
+ * a volta no fim. O fluxo é obtido cifrando zeros no próprio buffer.
+ */
+static void Keystream_Refill(CHIMA_Keystream *pKs, uint64_t ui64Head) {
+    uint32_t bs = (pKs->pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    uint8_t *p = pKs->pucRing + (size_t)(ui64Head % pKs->szCapacity);
+    uint64_t t0, ns;
+
+    t0 = Now_Ns();
+    memset(p, 0, CHIMA_KS_CHUNK);
+    if (pKs->xMode == CIPHER_MODE_OFB)
+        CHIMA_EncryptOFB_Buf(pKs->pCtx, p, p, CHIMA_KS_CHUNK / bs, pKs->aucIv);
+    else
+        CHIMA_EncryptCTR_Buf(pKs->pCtx, p, p, CHIMA_KS_CHUNK / bs, pKs->aucIv);
+    ns = Now_Ns() - t0;
+
+    atomic_fetch_add_explicit(&pKs->ui64Refills, 1, memory_order_relaxed);
+    atomic_store_explicit(&pKs->ui64RefillNsLast, ns, memory_order_relaxed);
+    atomic_fetch_add_explicit(&pKs->ui64RefillNsTotal, ns, memory_order_relaxed);
+    if (ns > atomic_load_explicit(&pKs->ui64RefillNsMax, memory_order_relaxed))
+        atomic_store_explicit(&pKs->ui64RefillNsMax, ns, memory_order_relaxed);
+}
+
+/**
+ * @brief Laço da thread geradora.
+ */
+static void *Keystream_Thread(void *pArg) {
+    CHIMA_Keystream *pKs = (CHIMA_Keystream *)pArg;
+    uint64_t ui64Head;
+
+    for (;;) {
+        ui64Head = atomic_load(&pKs->ui64Head);
+
+        if (pKs->szCapacity - (size_t)(ui64Head - atomic_load(&pKs->ui64Tail)) < CHIMA_KS_CHUNK) {
+            pthread_mutex_lock(&pKs->xLock);
+            atomic_store(&pKs->iProducerWaiting, 1);
+            while (!atomic_load(&pKs->iStop)
+                && pKs->szCapacity - (size_t)(ui64Head - atomic_load(&pKs->ui64Tail)) < CHIMA_KS_CHUNK)
+                pthread_cond_wait(&pKs->xSpace, &pKs->xLock);
+            atomic_store(&pKs->iProducerWaiting, 0);
+            pthread_mutex_unlock(&pKs->xLock);
+        }
+        if (atomic_load(&pKs->iStop))
+            break;
+
+        Keystream_Refill(pKs, ui64Head);
+        atomic_store(&pKs->ui64Head, ui64Head + CHIMA_KS_CHUNK);
+
+        if (atomic_load(&pKs->iConsumerWaiting)) {
+            pthread_mutex_lock(&pKs->xLock);
+            pthread_cond_signal(&pKs->xData);
+            pthread_mutex_unlock(&pKs->xLock);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Cria um gerador e inicia sua thread.
+ *
+ * @param pCtx       Contexto com as chaves
+ * @param xMode      CIPHER_MODE_OFB ou CIPHER_MODE_CTR
+ * @param iv         IV (OFB) ou contador inicial (CTR)
+ * @param szCapacity Capacidade em bytes (0 usa o padrão)
+ * @return Gerador ou NULL em erro
+ */
+CHIMA_Keystream *CHIMA_KeystreamCreate(const CHIMA_Ctx *pCtx, CipherMode xMode, const uint8_t *iv, size_t szCapacity) {
+    CHIMA_Keystream *pKs;
+    uint32_t bs;
+
+    if (pCtx == NULL || iv == NULL || (xMode != CIPHER_MODE_OFB && xMode != CIPHER_MODE_CTR))
+        return NULL;
+    bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+
+    if (szCapacity == 0)
+        szCapacity = CHIMA_KS_DEFAULT_CAPACITY;
+    szCapacity = (szCapacity + CHIMA_KS_CHUNK - 1) / CHIMA_KS_CHUNK * CHIMA_KS_CHUNK;
+    if (szCapacity < 2 * CHIMA_KS_CHUNK)
+        szCapacity = 2 * CHIMA_KS_CHUNK;
+
+    pKs = (CHIMA_Keystream *)calloc(1, sizeof(*pKs));
+    if (pKs == NULL)
+        return NULL;
+    pKs->pucRing = (uint8_t *)malloc(szCapacity);
+    if (pKs->pucRing == NULL) {
+        free(pKs);
+        return NULL;
+    }
+
+    pKs->pCtx = pCtx;
+    pKs->xMode = xMode;
+    pKs->szCapacity = szCapacity;
+    memcpy(pKs->aucIv, iv, bs);
+    atomic_init(&pKs->ui64Head, 0);
+    atomic_init(&pKs->ui64Tail, 0);
+    atomic_init(&pKs->iProducerWaiting, 0);
+    atomic_init(&pKs->iConsumerWaiting, 0);
+    atomic_init(&pKs->iStop, 0);
+    pthread_mutex_init(&pKs->xLock, NULL);
+    pthread_cond_init(&pKs->xSpace, NULL);
+    pthread_cond_init(&pKs->xData, NULL);
+
+    if (pthread_create(&pKs->xThread, NULL, Keystream_Thread, pKs) != 0) {
+        pthread_cond_destroy(&pKs->xData);
+        pthread_cond_destroy(&pKs->xSpace);
+        pthread_mutex_destroy(&pKs->xLock);
+        SecureZero(pKs->aucIv, sizeof(pKs->aucIv));
+        free(pKs->pucRing);
+        free(pKs);
+        return NULL;
+    }
+    return pKs;
+}
+
+/**
+ * @brief Encerra a thread, apaga o buffer e libera o gerador.
+ *
+ * @param pKs Gerador (pode ser NULL)
+ */
+void CHIMA_KeystreamDestroy(CHIMA_Keystream *pKs) {
+    if (pKs == NULL)
+        return;
+
+    pthread_mutex_lock(&pKs->xLock);
+    atomic_store(&pKs->iStop, 1);
+    pthread_cond_signal(&pKs->xSpace);
+    pthread_mutex_unlock(&pKs->xLock);
+    pthread_join(pKs->xThread, NULL);
+
+    pthread_cond_destroy(&pKs->xData);
+    pthread_cond_destroy(&pKs->xSpace);
+    pthread_mutex_destroy(&pKs->xLock);
+    SecureZero(pKs->pucRing, pKs->szCapacity);
+    SecureZero(pKs->aucIv, sizeof(pKs->aucIv));
+    free(pKs->pucRing);
+    free(pKs);
+}
+
+/**
+ * @brief Cifra ou decifra len bytes com o fluxo já pronto.
+ *
+ * @param pKs Gerador
+ * @param in  Entrada
+ * @param out Saída (pode ser igual a in)
+ * @param len Tamanho em bytes
+ * @return 0 em caso de sucesso, -1 se os parâmetros forem inválidos
+ */
+int CHIMA_KeystreamXor(CHIMA_Keystream *pKs, const uint8_t *in, uint8_t *out, size_t len) {
+    uint64_t ui64Tail, ui64Head, t0;
+    size_t szOff, n;
+
+    if (pKs == NULL || ((in == NULL || out == NULL) && len > 0))
+        return -1;
+
+    ui64Tail = atomic_load_explicit(&pKs->ui64Tail, memory_order_relaxed);
+    while (len > 0) {
+        ui64Head = atomic_load(&pKs->ui64Head);
+        if (ui64Head == ui64Tail) {
+            t0 = Now_Ns();
+            pthread_mutex_lock(&pKs->xLock);
+            atomic_store(&pKs->iConsumerWaiting, 1);
+            while ((ui64Head = atomic_load(&pKs->ui64Head)) == ui64Tail)
+                pthread_cond_wait(&pKs->xData, &pKs->xLock);
+            atomic_store(&pKs->iConsumerWaiting, 0);
+            pthread_mutex_unlock(&pKs->xLock);
+            atomic_fetch_add_explicit(&pKs->ui64Stalls, 1, memory_order_relaxed);
+            atomic_fetch_add_explicit(&pKs->ui64StallNsTotal, Now_Ns() - t0, memory_order_relaxed);
+        }
+
+        // Até o fim do que está pronto, sem passar do fim do buffer
+        szOff = (size_t)(ui64Tail % pKs->szCapacity);
+        n = (size_t)(ui64Head - ui64Tail);
+        if (n > pKs->szCapacity - szOff)
+            n = pKs->szCapacity - szOff;
+        if (n > len)
+            n = len;
+
+        XOR_Blocks(out, in, pKs->pucRing + szOff, (uint32_t)n);
+        in += n;
+        out += n;
+        len -= n;
+        ui64Tail += n;
+        atomic_store(&pKs->ui64Tail, ui64Tail);
+
+        if (atomic_load(&pKs->iProducerWaiting)) {
+            pthread_mutex_lock(&pKs->xLock);
+            pthread_cond_signal(&pKs->xSpace);
+            pthread_mutex_unlock(&pKs->xLock);
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Lê as estatísticas do gerador.
+ *
+ * @param pKs    Gerador
+ * @param pStats Recebe as estatísticas
+ */
+void CHIMA_KeystreamGetStats(CHIMA_Keystream *pKs, CHIMA_KeystreamStats *pStats) {
+    uint64_t ui64Tail, ui64Head;
+
+    if (pKs == NULL || pStats == NULL)
+        return;
+
+    ui64Tail = atomic_load(&pKs->ui64Tail);
+    ui64Head = atomic_load(&pKs->ui64Head);
+    pStats->szCapacity = pKs->szCapacity;
+    pStats->szFill = (size_t)(ui64Head - ui64Tail);
+    pStats->ui64Refills = atomic_load_explicit(&pKs->ui64Refills, memory_order_relaxed);
+    pStats->ui64RefillNsLast = atomic_load_explicit(&pKs->ui64RefillNsLast, memory_order_relaxed);
+    pStats->ui64RefillNsMax = atomic_load_explicit(&pKs->ui64RefillNsMax, memory_order_relaxed);
+    pStats->ui64RefillNsTotal = atomic_load_explicit(&pKs->ui64RefillNsTotal, memory_order_relaxed);
+    pStats->ui64Stalls = atomic_load_explicit(&pKs->ui64Stalls, memory_order_relaxed);
+    pStats->ui64StallNsTotal = atomic_load_explicit(&pKs->ui64StallNsTotal, memory_order_relaxed);
+}
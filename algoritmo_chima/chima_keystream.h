@@ -0,0 +1,102 @@
+/**
+ * @file chima_keystream.h
+ * @author
+ * @brief Fluxo de chave OFB/CTR pré-calculado em segundo plano.
+ * @version
+ * @date 2025-06-13
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef CHIMA_KEYSTREAM_H
+#define CHIMA_KEYSTREAM_H
+
+
+// INCLUSÕES //
+
+#include "chima_crypto.h"
+
+
+// DEFINIÇÕES //
+
+/** Bytes gerados por recarga do buffer circular */
+#define CHIMA_KS_CHUNK            4096
+/** Capacidade padrão do buffer circular, em bytes */
+#define CHIMA_KS_DEFAULT_CAPACITY (64 * 1024)
+
+
+// TIPOS //
+
+/** Gerador de fluxo de chave em segundo plano (opaco) */
+typedef struct CHIMA_Keystream CHIMA_Keystream;
+
+/**
+ * @brief Estatísticas do gerador.
+ *
+ * As latências são medidas com relógio monotônico, em nanossegundos.
+ */
+typedef struct {
+    size_t   szCapacity;        /**< Capacidade do buffer, em bytes */
+    size_t   szFill;            /**< Bytes prontos no momento da consulta */
+    uint64_t ui64Refills;       /**< Recargas de CHIMA_KS_CHUNK bytes */
+    uint64_t ui64RefillNsLast;  /**< Duração da última recarga */
+    uint64_t ui64RefillNsMax;   /**< Maior duração de recarga */
+    uint64_t ui64RefillNsTotal; /**< Soma das durações de recarga */
+    uint64_t ui64Stalls;        /**< Vezes em que o consumidor esperou por fluxo */
+    uint64_t ui64StallNsTotal;  /**< Tempo total de espera do consumidor */
+} CHIMA_KeystreamStats;
+
+
+// PROTÓTIPOS DE FUNÇÃO //
+
+/**
+ * @brief Cria um gerador e inicia sua thread.
+ *
+ * A thread preenche um buffer circular com o fluxo de chave de OFB ou CTR
+ * a partir do iv, à frente do consumo. O contexto deve continuar válido
+ * até CHIMA_KeystreamDestroy.
+ *
+ * @param pCtx       Contexto com as chaves
+ * @param xMode      CIPHER_MODE_OFB ou CIPHER_MODE_CTR
+ * @param iv         IV (OFB) ou contador inicial (CTR)
+ * @param szCapacity Capacidade em bytes (0 usa CHIMA_KS_DEFAULT_CAPACITY;
+ *                   arredondada para múltiplo de CHIMA_KS_CHUNK, mínimo
+ *                   dois)
+ * @return Gerador ou NULL em erro
+ */
+CHIMA_Keystream *CHIMA_KeystreamCreate(const CHIMA_Ctx *pCtx, CipherMode xMode, const uint8_t *iv, size_t szCapacity);
+
+/**
+ * @brief Encerra a thread, apaga o buffer e libera o gerador.
+ *
+ * @param pKs Gerador (pode ser NULL)
+ */
+void CHIMA_KeystreamDestroy(CHIMA_Keystream *pKs);
+
+/**
+ * @brief Cifra ou decifra len bytes com o fluxo já pronto.
+ *
+ * Consome o fluxo byte a byte, na ordem, então mensagens consecutivas
+ * formam um único fluxo OFB/CTR, igual ao de CHIMA_Encrypt*_Buf sobre os
+ * dados concatenados. Se o buffer não tiver fluxo suficiente, espera a
+ * thread geradora. Só uma thread deve consumir de cada gerador.
+ *
+ * @param pKs Gerador
+ * @param in  Entrada
+ * @param out Saída (pode ser igual a in)
+ * @param len Tamanho em bytes
+ * @return 0 em caso de sucesso, -1 se os parâmetros forem inválidos
+ */
+int CHIMA_KeystreamXor(CHIMA_Keystream *pKs, const uint8_t *in, uint8_t *out, size_t len);
+
+/**
+ * @brief Lê as estatísticas do gerador.
+ *
+ * @param pKs    Gerador
+ * @param pStats Recebe as estatísticas
+ */
+void CHIMA_KeystreamGetStats(CHIMA_Keystream *pKs, CHIMA_KeystreamStats *pStats);
+
+
+#endif /* CHIMA_KEYSTREAM_H */
@@ -0,0 +1,180 @@
+/**
+ * @file chima_packed.c
+ * @author
+ * @brief Cifragem de vetores de float/int32_t empacotados em blocos.
+ * @version
+ * @date 2025-06-13
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * A cifragem empacota direto na saída e cifra no próprio buffer. A
+ * decifração passa por um buffer de PACKED_CHUNK bytes: o primeiro trecho
+ * traz o cabeçalho, que é validado antes de qualquer valor ser copiado, e
+ * o padding é conferido no último.
+ */
+
+
+// INCLUSÕES //
+
+#include "chima_packed.h"
+#include "chima_iov.h"
+#include <string.h>
+
+
+// DEFINIÇÕES //
+
+/** Bytes decifrados por vez (múltiplo de 16) */
+#define PACKED_CHUNK 4096
+
+
+// FUNÇÕES //
+
+/**
+ * @brief Empacota e cifra count valores de 4 bytes.
+ */
+static int Packed_Encrypt(const CHIMA_Ctx *pCtx, CipherMode xMode, const uint8_t *iv,
+     const void *values, size_t count, uint8_t *out, size_t *pszOutLen) {
+    uint32_t bs;
+    uint8_t aucIv[16] = {0};
+    size_t len;
+
+    if (pCtx == NULL || xMode > CIPHER_MODE_CTR || (xMode != CIPHER_MODE_ECB && iv == NULL)
+        || (values == NULL && count > 0) || out == NULL || pszOutLen == NULL)
+        return -1;
+    bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+
+    len = PaddingArray(values, count, out, pCtx->xSize);
+    if (len == 0)
+        return -1;
+
+    if (xMode != CIPHER_MODE_ECB)
+        memcpy(aucIv, iv, bs);
+    CHIMA_EncryptInPlace(pCtx, xMode, out, len / bs, aucIv);
+    SecureZero(aucIv, sizeof(aucIv));
+    *pszOutLen = len;
+    return 0;
+}
+
+/**
+ * @brief Decifra e desempacota um vetor de valores de 4 bytes.
+ */
+static int Packed_Decrypt(const CHIMA_Ctx *pCtx, CipherMode xMode, const uint8_t *iv,
+     const uint8_t *in, size_t len, void *values, size_t maxCount, size_t *pszCount) {
+    uint8_t aucBuf[PACKED_CHUNK], aucIv[16] = {0}, diff = 0;
+    uint8_t *pucValues = (uint8_t *)values;
+    size_t szPos, n, szData = 0, lo, hi;
+    uint32_t bs, count = 0;
+
+    if (pCtx == NULL || xMode > CIPHER_MODE_CTR || (xMode != CIPHER_MODE_ECB && iv == NULL)
+        || in == NULL || pszCount == NULL)
+        return -1;
+    bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    if (len < bs || len % bs != 0)
+        return -1;
+
+    if (xMode != CIPHER_MODE_ECB)
+        memcpy(aucIv, iv, bs);
+
+    for (szPos = 0; szPos < len; szPos += n) {
+        n = (len - szPos < PACKED_CHUNK) ? len - szPos : PACKED_CHUNK;
+        memcpy(aucBuf, in + szPos, n);
+        CHIMA_DecryptInPlace(pCtx, xMode, aucBuf, n / bs, aucIv);
+
+        if (szPos == 0) {
+            szData = CheckPackedHeader(aucBuf, len, pCtx->xSize, values, maxCount, &count);
+            if (szData == 0) {
+                diff = 1;
+                break;
+            }
+        }
+
+        // Valores contidos neste trecho
+        lo = (szPos > PACKED_HEADER_BYTES) ? szPos : PACKED_HEADER_BYTES;
+        hi = (szPos + n < szData) ? szPos + n : szData;
+        if (lo < hi)
+            memcpy(pucValues + (lo - PACKED_HEADER_BYTES), aucBuf + (lo - szPos), hi - lo);
+
+        // Padding contido neste trecho
+        diff |= CheckPackedPadding(aucBuf, szPos, n, szData, len);
+    }
+
+    SecureZero(aucBuf, sizeof(aucBuf));
+    SecureZero(aucIv, sizeof(aucIv));
+    if (diff != 0) {
+        if (szData > PACKED_HEADER_BYTES)
+            SecureZero(values, szData - PACKED_HEADER_BYTES);
+        return -1;
+    }
+    *pszCount = count;
+    return 0;
+}
+
+/**
+ * @brief Empacota e cifra um vetor de float.
+ *
+ * @param pCtx      Contexto
+ * @param xMode     Modo de operação
+ * @param iv        IV (ignorado em ECB)
+ * @param values    Valores
+ * @param count     Quantidade de valores
+ * @param out       Saída com CHIMA_PackedSize(pCtx, count) bytes
+ * @param pszOutLen Recebe o tamanho da saída
+ * @return 0 em caso de sucesso, -1 em erro
+ */
+int CHIMA_EncryptFloatArray(const CHIMA_Ctx *pCtx, CipherMode xMode, const uint8_t *iv,
+     const float *values, size_t count, uint8_t *out, size_t *pszOutLen) {
+    return Packed_Encrypt(pCtx, xMode, iv, values, count, out, pszOutLen);
+}
+
+/**
+ * @brief Decifra e desempacota um vetor de float.
+ *
+ * @param pCtx     Contexto
+ * @param xMode    Modo de operação
+ * @param iv       IV (ignorado em ECB)
+ * @param in       Vetor cifrado
+ * @param len      Tamanho em bytes
+ * @param values   Recebe os valores
+ * @param maxCount Capacidade de values
+ * @param pszCount Recebe a quantidade de valores
+ * @return 0 em caso de sucesso, -1 em erro
+ */
+int CHIMA_DecryptFloatArray(const CHIMA_Ctx *pCtx, CipherMode xMode, const uint8_t *iv,
+     const uint8_t *in, size_t len, float *values, size_t maxCount, size_t *pszCount) {
+    return Packed_Decrypt(pCtx, xMode, iv, in, len, values, maxCount, pszCount);
+}
+
+/**
+ * @brief Empacota e cifra um vetor de int32_t.
+ *
+ * @param pCtx      Contexto
+ * @param xMode     Modo de operação
+ * @param iv        IV (ignorado em ECB)
+ * @param values    Valores
+ * @param count     Quantidade de valores
+ * @param out       Saída com CHIMA_PackedSize(pCtx, count) bytes
+ * @param pszOutLen Recebe o tamanho da saída
+ * @return 0 em caso de sucesso, -1 em erro
+ */
+int CHIMA_EncryptInt32Array(const CHIMA_Ctx *pCtx, CipherMode xMode, const uint8_t *iv,
+     const int32_t *values, size_t count, uint8_t *out, size_t *pszOutLen) {
+    return Packed_Encrypt(pCtx, xMode, iv, values, count, out, pszOutLen);
+}
+
+/**
+ * @brief Decifra e desempacota um vetor de int32_t.
+ *
+ * @param pCtx     Contexto
+ * @param xMode    Modo de operação
+ * @param iv       IV (ignorado em ECB)
+ * @param in       Vetor cifrado
+ * @param len      Tamanho em bytes
+ * @param values   Recebe os valores
+ * @param maxCount Capacidade de values
+ * @param pszCount Recebe a quantidade de valores
+ * @return 0 em caso de sucesso, -1 em erro
+ */
+int CHIMA_DecryptInt32Array(const CHIMA_Ctx *pCtx, CipherMode xMode, const uint8_t *iv,
+     const uint8_t *in, size_t len, int32_t *values, size_t maxCount, size_t *pszCount) {
+    return Packed_Decrypt(pCtx, xMode, iv, in, len, values, maxCount, pszCount);
+}
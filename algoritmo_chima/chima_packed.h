@@ -0,0 +1,55 @@
+/**
+ * @file chima_packed.h
+ * @author
+ * @brief Cifragem de vetores de float/int32_t empacotados em blocos.
+ * @version
+ * @date 2025-06-13
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef CHIMA_PACKED_H
+#define CHIMA_PACKED_H
+
+
+// INCLUSÕES //
+
+#include "chima_crypto.h"
+
+
+// DEFINIÇÕES //
+
+/** Bytes cifrados para count valores no contexto pCtx (ver PackedSize) */
+#define CHIMA_PackedSize(pCtx, count) PackedSize((count), (pCtx)->xSize)
+
+
+// PROTÓTIPOS DE FUNÇÃO //
+
+/*
+ * Em vez de um bloco com padding por valor (Padding/RemovePadding), o
+ * vetor inteiro é empacotado por PaddingArray (cabeçalho com a quantidade,
+ * valores contíguos e um único padding final) e cifrado de uma vez pelas
+ * funções em massa. Com blocos de 128 bits isso reduz até 4x as chamadas
+ * de cifra e os bytes transmitidos.
+ *
+ * As funções de cifragem gravam CHIMA_PackedSize(pCtx, count) bytes em out
+ * e informam o tamanho em *pszOutLen. As de decifração conferem o tamanho,
+ * o cabeçalho e o padding; em erro nenhum valor é entregue. Valem os cinco
+ * modos; o iv (ignorado em ECB) não é alterado.
+ *
+ * Retornam 0 em caso de sucesso e -1 em erro.
+ */
+
+int CHIMA_EncryptFloatArray(const CHIMA_Ctx *pCtx, CipherMode xMode, const uint8_t *iv,
+     const float *values, size_t count, uint8_t *out, size_t *pszOutLen);
+int CHIMA_DecryptFloatArray(const CHIMA_Ctx *pCtx, CipherMode xMode, const uint8_t *iv,
+     const uint8_t *in, size_t len, float *values, size_t maxCount, size_t *pszCount);
+
+int CHIMA_EncryptInt32Array(const CHIMA_Ctx *pCtx, CipherMode xMode, const uint8_t *iv,
+     const int32_t *values, size_t count, uint8_t *out, size_t *pszOutLen);
+int CHIMA_DecryptInt32Array(const CHIMA_Ctx *pCtx, CipherMode xMode, const uint8_t *iv,
+     const uint8_t *in, size_t len, int32_t *values, size_t maxCount, size_t *pszCount);
+
+
+#endif /* CHIMA_PACKED_H */
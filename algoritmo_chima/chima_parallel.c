@@ -0,0 +1,566 @@
+/**
+ * @file chima_parallel.c
+ * @author
+ * @brief Pool de threads e modos em massa paralelos.
+ * @version
+ * @date 2025-06-13
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * O buffer é dividido em partes do tamanho do cache e cada parte vira uma
+ * tarefa independente. As threads do pool e a própria thread chamadora
+ * retiram tarefas de um contador atômico até esgotá-las, então partes
+ * mais lentas não deixam threads paradas. O pool é criado no primeiro uso
+ * e mantido entre chamadas; só uma chamada o usa por vez.
+ */
+
+
+// INCLUSÕES //
+
+#include "chima_parallel.h"
+#include "chima_xts.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+
+// TIPOS //
+
+/** Tarefa do pool: processa a parte de índice szIndex */
+typedef void (*TaskFn)(void *pArg, size_t szIndex);
+
+/**
+ * @brief Estado do pool de threads.
+ *
+ * Os campos da tarefa corrente só mudam com a trava tomada e nenhuma
+ * thread ativa (ui32Active == 0); Run_Parallel espera por isso antes de
+ * publicar uma tarefa.
+ */
+typedef struct {
+    pthread_mutex_t xLock;                               /**< Protege os campos abaixo */
+    pthread_cond_t  xWork;                               /**< Sinaliza nova tarefa ou encerramento */
+    pthread_cond_t  xIdle;                               /**< Sinaliza ui32Active == 0 */
+    pthread_t       axThreads[CHIMA_PAR_MAX_THREADS];    /**< Threads auxiliares */
+    uint32_t        ui32Workers;                         /**< Threads auxiliares criadas */
+    uint32_t        ui32Active;                          /**< Threads dentro da tarefa corrente */
+    uint64_t        ui64Generation;                      /**< Incrementado a cada tarefa */
+    int             iShutdown;                           /**< Pede o encerramento das threads */
+    TaskFn          pfnTask;                             /**< Tarefa corrente */
+    void           *pArg;                                /**< Argumento da tarefa */
+    size_t          szTasks;                             /**< Partes da tarefa */
+    atomic_size_t   szNext;                              /**< Próxima parte livre */
+} ThreadPool;
+
+/**
+ * @brief Operação de um job em massa.
+ */
+typedef enum {
+    BULK_ECB_ENCRYPT,
+    BULK_ECB_DECRYPT,
+    BULK_CTR,
+    BULK_CBC_DECRYPT,
+    BULK_CFB_DECRYPT
+} BulkOp;
+
+/**
+ * @brief Argumentos dos modos em massa paralelos.
+ */
+typedef struct {
+    const CHIMA_Ctx *pCtx;
+    const uint8_t   *in;
+    uint8_t         *out;
+    size_t           nblocks;       /**< Blocos no total */
+    size_t           szChunkBlocks; /**< Blocos por parte */
+    const uint8_t   *iv;            /**< Contador inicial (CTR) ou IV de cada parte (CBC/CFB) */
+    BulkOp           xOp;           /**< Operação */
+} BulkJob;
+
+/**
+ * @brief Argumentos do XTS paralelo.
+ */
+typedef struct {
+    const CHIMA_Ctx *pDataCtx;
+    const CHIMA_Ctx *pTweakCtx;
+    uint64_t         ui64Sector;     /**< Primeiro setor */
+    size_t           szSectorSize;   /**< Bytes por setor */
+    const uint8_t   *in;
+    uint8_t         *out;
+    size_t           nsectors;       /**< Setores no total */
+    size_t           szChunkSectors; /**< Setores por parte */
+    int              iDecrypt;       /**< 1 para decifrar */
+} XtsJob;
+
+
+// VARIÁVEIS GLOBAIS //
+
+static ThreadPool g_xPool = {
+    .xLock = PTHREAD_MUTEX_INITIALIZER,
+    .xWork = PTHREAD_COND_INITIALIZER,
+    .xIdle = PTHREAD_COND_INITIALIZER,
+};
+/** Garante uma única chamada no pool por vez */
+static pthread_mutex_t g_xSubmitLock = PTHREAD_MUTEX_INITIALIZER;
+
+/** Threads configuradas (0 = processadores disponíveis) */
+static _Atomic uint32_t g_ui32Threads = 0;
+/** Bytes mínimos por parte */
+static _Atomic size_t g_szMinChunk = CHIMA_PAR_DEFAULT_CHUNK;
+
+
+// FUNÇÕES //
+
+/**
+ * @brief Executa partes da tarefa corrente até esgotá-las.
+ */
+static void Run_Tasks(ThreadPool *pPool) {
+    size_t i;
+
+    while ((i = atomic_fetch_add_explicit(&pPool->szNext, 1, memory_order_relaxed)) < pPool->szTasks)
+        pPool->pfnTask(pPool->pArg, i);
+}
+
+/**
+ * @brief Laço das threads auxiliares.
+ *
+ * @param pArg Pool
+ * @return NULL
+ */
+static void *Worker_Main(void *pArg) {
+    ThreadPool *pPool = (ThreadPool *)pArg;
+    uint64_t seen;
+
+    pthread_mutex_lock(&pPool->xLock);
+    seen = pPool->ui64Generation;
+    for (;;) {
+        while (pPool->ui64Generation == seen && !pPool->iShutdown)
+            pthread_cond_wait(&pPool->xWork, &pPool->xLock);
+        if (pPool->iShutdown)
+            break;
+        seen = pPool->ui64Generation;
+        pPool->ui32Active++;
+        pthread_mutex_unlock(&pPool->xLock);
+
+        Run_Tasks(pPool);
+
+        pthread_mutex_lock(&pPool->xLock);
+        if (--pPool->ui32Active == 0)
+            pthread_cond_broadcast(&pPool->xIdle);
+    }
+    pthread_mutex_unlock(&pPool->xLock);
+    return NULL;
+}
+
+/**
+ * @brief Encerra e aguarda as threads auxiliares.
+ *
+ * Chamada com g_xSubmitLock tomada ou sem uso concorrente do pool.
+ */
+static void Pool_Stop(ThreadPool *pPool) {
+    pthread_mutex_lock(&pPool->xLock);
+    pPool->iShutdown = 1;
+    pthread_cond_broadcast(&pPool->xWork);
+    pthread_mutex_unlock(&pPool->xLock);
+
+    for (uint32_t t = 0; t < pPool->ui32Workers; t++)
+        pthread_join(pPool->axThreads[t], NULL);
+
+    pPool->ui32Workers = 0;
+    pPool->iShutdown = 0;
+}
+
+/**
+ * @brief Quantidade de threads a usar, já limitada.
+ */
+static uint32_t Thread_Count(void) {
+    uint32_t threads = atomic_load_explicit(&g_ui32Threads, memory_order_relaxed);
+    long online;
+
+    if (threads == 0) {
+        online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (online > 0) ? (uint32_t)online : 1;
+    }
+    return (threads > CHIMA_PAR_MAX_THREADS) ? CHIMA_PAR_MAX_THREADS : threads;
+}
+
+/**
+ * @brief Ajusta o número de threads auxiliares do pool.
+ *
+ * Chamada com g_xSubmitLock tomada. Se alguma thread não puder ser
+ * criada, o pool segue com as que existem.
+ *
+ * @param ui32Workers Threads auxiliares desejadas
+ */
+static void Pool_Resize(ThreadPool *pPool, uint32_t ui32Workers) {
+    if (pPool->ui32Workers == ui32Workers)
+        return;
+    if (pPool->ui32Workers != 0)
+        Pool_Stop(pPool);
+
+    while (pPool->ui32Workers < ui32Workers) {
+        if (pthread_create(&pPool->axThreads[pPool->ui32Workers], NULL, Worker_Main, pPool) != 0)
+            break;
+        pPool->ui32Workers++;
+    }
+}
+
+/**
+ * @brief Executa szTasks partes de uma tarefa no pool.
+ *
+ * A thread chamadora também processa partes. Se outra chamada estiver
+ * usando o pool, todas as partes rodam na thread chamadora.
+ *
+ * @param pfnTask Função de cada parte
+ * @param pArg    Argumento repassado
+ * @param szTasks Quantidade de partes
+ */
+static void Run_Parallel(TaskFn pfnTask, void *pArg, size_t szTasks) {
+    ThreadPool *pPool = &g_xPool;
+    uint32_t threads = Thread_Count();
+
+    if (threads <= 1 || szTasks <= 1 || pthread_mutex_trylock(&g_xSubmitLock) != 0) {
+        for (size_t i = 0; i < szTasks; i++)
+            pfnTask(pArg, i);
+        return;
+    }
+
+    Pool_Resize(pPool, threads - 1);
+
+    pthread_mutex_lock(&pPool->xLock);
+    // Uma thread que acordou tarde para a tarefa anterior pode ter entrado
+    // depois que a chamada anterior retornou; espera que saia antes de
+    // trocar os campos que ela lê
+    while (pPool->ui32Active != 0)
+        pthread_cond_wait(&pPool->xIdle, &pPool->xLock);
+    pPool->pfnTask = pfnTask;
+    pPool->pArg = pArg;
+    pPool->szTasks = szTasks;
+    atomic_store_explicit(&pPool->szNext, 0, memory_order_relaxed);
+    pPool->ui64Generation++;
+    pthread_cond_broadcast(&pPool->xWork);
+    pthread_mutex_unlock(&pPool->xLock);
+
+    Run_Tasks(pPool);
+
+    // Todas as partes já foram retiradas; espera as que ainda rodam
+    pthread_mutex_lock(&pPool->xLock);
+    while (pPool->ui32Active != 0)
+        pthread_cond_wait(&pPool->xIdle, &pPool->xLock);
+    pthread_mutex_unlock(&pPool->xLock);
+
+    pthread_mutex_unlock(&g_xSubmitLock);
+}
+
+/**
+ * @brief Blocos por parte para o tamanho de bloco dado.
+ *
+ * @param bs Bytes por bloco
+ * @return Blocos por parte (ao menos 1)
+ */
+static size_t Chunk_Blocks(uint32_t bs) {
+    size_t chunk = atomic_load_explicit(&g_szMinChunk, memory_order_relaxed) / bs;
+    return (chunk == 0) ? 1 : chunk;
+}
+
+/**
+ * @brief Soma um deslocamento a um contador big-endian.
+ *
+ * @param counter Contador (alterado)
+ * @param len     Tamanho do contador em bytes
+ * @param add     Valor a somar
+ */
+static void Counter_Add(uint8_t *counter, uint32_t len, uint64_t add) {
+    unsigned int carry = 0, sum;
+
+    for (int32_t i = (int32_t)len - 1; i >= 0 && (add != 0 || carry != 0); i--) {
+        sum = counter[i] + (unsigned int)(add & 0xFF) + carry;
+        counter[i] = (uint8_t)sum;
+        carry = sum >> 8;
+        add >>= 8;
+    }
+}
+
+/**
+ * @brief Processa uma parte de um job em massa.
+ *
+ * No CTR a parte começa no contador iv + índice do primeiro bloco; em
+ * CBC/CFB o IV da parte é o último bloco cifrado da parte anterior,
+ * copiado antes do início do job porque a saída pode sobrescrever a
+ * entrada.
+ */
+static void Bulk_Task(void *pArg, size_t szIndex) {
+    const BulkJob *pJob = (const BulkJob *)pArg;
+    uint32_t bs = (pJob->pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    size_t first = szIndex * pJob->szChunkBlocks;
+    size_t n = pJob->nblocks - first;
+    const uint8_t *in = pJob->in + first * bs;
+    uint8_t *out = pJob->out + first * bs;
+    uint8_t chain[16];
+
+    if (n > pJob->szChunkBlocks)
+        n = pJob->szChunkBlocks;
+
+    switch (pJob->xOp) {
+        case BULK_ECB_ENCRYPT:
+            CHIMA_EncryptECB_Buf(pJob->pCtx, in, out, n);
+            break;
+        case BULK_ECB_DECRYPT:
+            CHIMA_DecryptECB_Buf(pJob->pCtx, in, out, n);
+            break;
+        case BULK_CTR:
+            memcpy(chain, pJob->iv, bs);
+            Counter_Add(chain, bs, first);
+            CHIMA_EncryptCTR_Buf(pJob->pCtx, in, out, n, chain);
+            break;
+        case BULK_CBC_DECRYPT:
+            memcpy(chain, pJob->iv + szIndex * bs, bs);
+            CHIMA_DecryptCBC_Buf(pJob->pCtx, in, out, n, chain);
+            break;
+        case BULK_CFB_DECRYPT:
+            memcpy(chain, pJob->iv + szIndex * bs, bs);
+            CHIMA_DecryptCFB_Buf(pJob->pCtx, in, out, n, chain);
+            break;
+    }
+}
+
+/**
+ * @brief Distribui um job em massa entre as threads.
+ *
+ * @param pJob Job com szChunkBlocks ainda não preenchido
+ */
+static void Bulk_Parallel(BulkJob *pJob) {
+    uint32_t bs = (pJob->pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+
+    pJob->szChunkBlocks = Chunk_Blocks(bs);
+    Run_Parallel(Bulk_Task, pJob, (pJob->nblocks + pJob->szChunkBlocks - 1) / pJob->szChunkBlocks);
+}
+
+/**
+ * @brief Decifração CBC ou CFB paralela.
+ *
+ * Guarda antes o IV de cada parte (o último bloco cifrado da parte
+ * anterior) e o bloco que vira o IV seguinte, já que a saída pode
+ * sobrescrever a entrada. Sem pool ou sem memória para os IVs, recorre à
+ * versão *_Buf na thread chamadora.
+ *
+ * @param pCtx    Contexto
+ * @param in      Blocos cifrados
+ * @param out     Blocos claros (pode ser igual a in)
+ * @param nblocks Quantidade de blocos
+ * @param iv      IV de entrada; recebe o último bloco cifrado
+ * @param xOp     BULK_CBC_DECRYPT ou BULK_CFB_DECRYPT
+ */
+static void Chained_Decrypt_Parallel(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out,
+                                     size_t nblocks, uint8_t *iv, BulkOp xOp) {
+    uint32_t bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    size_t chunk = Chunk_Blocks(bs);
+    size_t tasks = (nblocks + chunk - 1) / chunk;
+    BulkJob xJob = { pCtx, in, out, nblocks, chunk, NULL, xOp };
+    uint8_t *pIvs = NULL, last[16];
+
+    if (tasks > 1 && Thread_Count() > 1)
+        pIvs = (uint8_t *)malloc(tasks * bs);
+    if (pIvs == NULL) {
+        if (xOp == BULK_CBC_DECRYPT)
+            CHIMA_DecryptCBC_Buf(pCtx, in, out, nblocks, iv);
+        else
+            CHIMA_DecryptCFB_Buf(pCtx, in, out, nblocks, iv);
+        return;
+    }
+
+    memcpy(pIvs, iv, bs);
+    for (size_t t = 1; t < tasks; t++)
+        memcpy(pIvs + t * bs, in + (t * chunk - 1) * bs, bs);
+    memcpy(last, in + (nblocks - 1) * bs, bs);
+
+    xJob.iv = pIvs;
+    Run_Parallel(Bulk_Task, &xJob, tasks);
+    memcpy(iv, last, bs);
+    free(pIvs);
+}
+
+/**
+ * @brief Processa uma parte de um job XTS: setores independentes.
+ */
+static void Xts_Task(void *pArg, size_t szIndex) {
+    const XtsJob *pJob = (const XtsJob *)pArg;
+    size_t first = szIndex * pJob->szChunkSectors;
+    size_t n = pJob->nsectors - first;
+    size_t off = first * pJob->szSectorSize;
+
+    if (n > pJob->szChunkSectors)
+        n = pJob->szChunkSectors;
+
+    if (pJob->iDecrypt)
+        CHIMA_XtsDecrypt(pJob->pDataCtx, pJob->pTweakCtx, pJob->ui64Sector + first, pJob->szSectorSize,
+                         pJob->in + off, pJob->out + off, n);
+    else
+        CHIMA_XtsEncrypt(pJob->pDataCtx, pJob->pTweakCtx, pJob->ui64Sector + first, pJob->szSectorSize,
+                         pJob->in + off, pJob->out + off, n);
+}
+
+/**
+ * @brief Distribui grupos de setores entre as threads.
+ *
+ * Os parâmetros são validados pela chamada serial com zero setores.
+ */
+static int Xts_Parallel(XtsJob *pJob) {
+    size_t chunk;
+
+    if (CHIMA_XtsEncrypt(pJob->pDataCtx, pJob->pTweakCtx, 0, pJob->szSectorSize, pJob->in, pJob->out, 0) != 0
+        || ((pJob->in == NULL || pJob->out == NULL) && pJob->nsectors > 0))
+        return -1;
+
+    chunk = atomic_load_explicit(&g_szMinChunk, memory_order_relaxed) / pJob->szSectorSize;
+    pJob->szChunkSectors = (chunk == 0) ? 1 : chunk;
+    Run_Parallel(Xts_Task, pJob, (pJob->nsectors + pJob->szChunkSectors - 1) / pJob->szChunkSectors);
+    return 0;
+}
+
+/**
+ * @brief Define quantas threads as funções *_Par usam.
+ *
+ * @param ui32Threads Quantidade de threads (0 = processadores disponíveis)
+ */
+void CHIMA_ParallelSetThreads(uint32_t ui32Threads) {
+    atomic_store_explicit(&g_ui32Threads, ui32Threads, memory_order_relaxed);
+}
+
+/**
+ * @brief Define o tamanho mínimo de cada parte do buffer.
+ *
+ * @param szMinChunk Bytes por parte (0 restaura o padrão)
+ */
+void CHIMA_ParallelSetMinChunk(size_t szMinChunk) {
+    atomic_store_explicit(&g_szMinChunk, szMinChunk ? szMinChunk : CHIMA_PAR_DEFAULT_CHUNK,
+                          memory_order_relaxed);
+}
+
+/**
+ * @brief Encerra as threads do pool.
+ */
+void CHIMA_ParallelShutdown(void) {
+    pthread_mutex_lock(&g_xSubmitLock);
+    if (g_xPool.ui32Workers != 0)
+        Pool_Stop(&g_xPool);
+    pthread_mutex_unlock(&g_xSubmitLock);
+}
+
+/**
+ * @brief Modo ECB - Encrypt paralelo de vários blocos
+ *
+ * @param pCtx
+ * @param in
+ * @param out
+ * @param nblocks
+ */
+void CHIMA_EncryptECB_Par(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks) {
+    BulkJob xJob = { pCtx, in, out, nblocks, 0, NULL, BULK_ECB_ENCRYPT };
+    Bulk_Parallel(&xJob);
+}
+
+/**
+ * @brief Modo ECB - Decrypt paralelo de vários blocos
+ *
+ * @param pCtx
+ * @param in
+ * @param out
+ * @param nblocks
+ */
+void CHIMA_DecryptECB_Par(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks) {
+    BulkJob xJob = { pCtx, in, out, nblocks, 0, NULL, BULK_ECB_DECRYPT };
+    Bulk_Parallel(&xJob);
+}
+
+/**
+ * @brief Modo CTR - Encrypt paralelo de vários blocos
+ *
+ * @param pCtx
+ * @param in
+ * @param out
+ * @param nblocks
+ * @param iv      Contador inicial; recebe o contador seguinte ao último bloco
+ */
+void CHIMA_EncryptCTR_Par(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv) {
+    uint32_t bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    BulkJob xJob = { pCtx, in, out, nblocks, 0, iv, BULK_CTR };
+
+    Bulk_Parallel(&xJob);
+    Counter_Add(iv, bs, nblocks);
+}
+
+/**
+ * @brief Modo CTR - Decrypt paralelo de vários blocos
+ *
+ * @param pCtx
+ * @param in
+ * @param out
+ * @param nblocks
+ * @param iv      Contador inicial; recebe o contador seguinte ao último bloco
+ */
+void CHIMA_DecryptCTR_Par(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv) {
+    CHIMA_EncryptCTR_Par(pCtx, in, out, nblocks, iv);
+}
+
+/**
+ * @brief Modo CBC - Decrypt paralelo de vários blocos
+ *
+ * @param pCtx
+ * @param in
+ * @param out
+ * @param nblocks
+ * @param iv      IV de entrada; recebe o último bloco cifrado
+ */
+void CHIMA_DecryptCBC_Par(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv) {
+    Chained_Decrypt_Parallel(pCtx, in, out, nblocks, iv, BULK_CBC_DECRYPT);
+}
+
+/**
+ * @brief Modo CFB - Decrypt paralelo de vários blocos
+ *
+ * @param pCtx
+ * @param in
+ * @param out
+ * @param nblocks
+ * @param iv      IV de entrada; recebe o último bloco cifrado
+ */
+void CHIMA_DecryptCFB_Par(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv) {
+    Chained_Decrypt_Parallel(pCtx, in, out, nblocks, iv, BULK_CFB_DECRYPT);
+}
+
+/**
+ * @brief Modo XTS - Encrypt paralelo de vários setores
+ *
+ * @param pDataCtx
+ * @param pTweakCtx
+ * @param ui64Sector
+ * @param szSectorSize
+ * @param in
+ * @param out
+ * @param nsectors
+ * @return 0 em caso de sucesso, -1 se os parâmetros forem inválidos
+ */
+int CHIMA_XtsEncrypt_Par(const CHIMA_Ctx *pDataCtx, const CHIMA_Ctx *pTweakCtx, uint64_t ui64Sector,
+     size_t szSectorSize, const uint8_t *in, uint8_t *out, size_t nsectors) {
+    XtsJob xJob = { pDataCtx, pTweakCtx, ui64Sector, szSectorSize, in, out, nsectors, 0, 0 };
+    return Xts_Parallel(&xJob);
+}
+
+/**
+ * @brief Modo XTS - Decrypt paralelo de vários setores
+ *
+ * @param pDataCtx
+ * @param pTweakCtx
+ * @param ui64Sector
+ * @param szSectorSize
+ * @param in
+ * @param out
+ * @param nsectors
+ * @return 0 em caso de sucesso, -1 se os parâmetros forem inválidos
+ */
+int CHIMA_XtsDecrypt_Par(const CHIMA_Ctx *pDataCtx, const CHIMA_Ctx *pTweakCtx, uint64_t ui64Sector,
+     size_t szSectorSize, const uint8_t *in, uint8_t *out, size_t nsectors) {
+    XtsJob xJob = { pDataCtx, pTweakCtx, ui64Sector, szSectorSize, in, out, nsectors, 0, 1 };
+    return Xts_Parallel(&xJob);
+}
@@ -0,0 +1,93 @@
+/**
+ * @file chima_parallel.h
+ * @author
+ * @brief Modos em massa distribuídos entre várias threads.
+ * @version
+ * @date 2025-06-13
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef CHIMA_PARALLEL_H
+#define CHIMA_PARALLEL_H
+
+
+// INCLUSÕES //
+
+#include "chima_crypto.h"
+
+
+// DEFINIÇÕES //
+
+/** Máximo de threads do pool (incluindo a thread chamadora) */
+#define CHIMA_PAR_MAX_THREADS     64
+/** Tamanho padrão de cada parte do buffer, em bytes (cabe no cache L2) */
+#define CHIMA_PAR_DEFAULT_CHUNK   (64 * 1024)
+
+
+// PROTÓTIPOS DE FUNÇÃO //
+
+/**
+ * @brief Define quantas threads as funções *_Par usam.
+ *
+ * A thread chamadora conta como uma delas. 0 usa o número de processadores
+ * disponíveis e 1 desativa o pool. Valores acima de CHIMA_PAR_MAX_THREADS
+ * são limitados. O pool é recriado na próxima chamada.
+ *
+ * @param ui32Threads Quantidade de threads
+ */
+void CHIMA_ParallelSetThreads(uint32_t ui32Threads);
+
+/**
+ * @brief Define o tamanho mínimo de cada parte do buffer.
+ *
+ * O buffer é dividido em partes de pelo menos szMinChunk bytes (o padrão
+ * é CHIMA_PAR_DEFAULT_CHUNK); buffers que não rendem duas partes são
+ * processados inteiramente na thread chamadora.
+ *
+ * @param szMinChunk Bytes por parte (0 restaura o padrão)
+ */
+void CHIMA_ParallelSetMinChunk(size_t szMinChunk);
+
+/**
+ * @brief Encerra as threads do pool.
+ *
+ * Opcional; as funções *_Par recriam o pool quando necessário. Não deve
+ * ser chamada enquanto outra thread usa as funções *_Par.
+ */
+void CHIMA_ParallelShutdown(void);
+
+/*
+ * Mesmo resultado de CHIMA_*_Buf, com as partes do buffer distribuídas
+ * entre as threads do pool. O contexto é apenas lido e pode ser
+ * compartilhado. No CTR cada parte começa no contador iv + índice do
+ * primeiro bloco, e o iv termina avançado de nblocks. Na decifração CBC e
+ * CFB cada parte usa como IV o último bloco cifrado da parte anterior, e o
+ * iv recebe o último bloco cifrado, como em *_Buf. Se o pool estiver
+ * ocupado por outra chamada, o buffer é processado na thread chamadora.
+ */
+
+void CHIMA_EncryptECB_Par(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks);
+void CHIMA_DecryptECB_Par(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks);
+
+void CHIMA_EncryptCTR_Par(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv);
+void CHIMA_DecryptCTR_Par(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv);
+
+void CHIMA_DecryptCBC_Par(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv);
+void CHIMA_DecryptCFB_Par(const CHIMA_Ctx *pCtx, const uint8_t *in, uint8_t *out, size_t nblocks, uint8_t *iv);
+
+/*
+ * Mesmo resultado de CHIMA_XtsEncrypt/CHIMA_XtsDecrypt, com grupos de
+ * setores (de pelo menos o tamanho mínimo de parte) distribuídos entre as
+ * threads. Retornam 0 em caso de sucesso e -1 se os parâmetros forem
+ * inválidos.
+ */
+
+int CHIMA_XtsEncrypt_Par(const CHIMA_Ctx *pDataCtx, const CHIMA_Ctx *pTweakCtx, uint64_t ui64Sector,
+     size_t szSectorSize, const uint8_t *in, uint8_t *out, size_t nsectors);
+int CHIMA_XtsDecrypt_Par(const CHIMA_Ctx *pDataCtx, const CHIMA_Ctx *pTweakCtx, uint64_t ui64Sector,
+     size_t szSectorSize, const uint8_t *in, uint8_t *out, size_t nsectors);
+
+
+#endif /* CHIMA_PARALLEL_H */
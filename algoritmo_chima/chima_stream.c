@@ -0,0 +1,343 @@
+/**
+ * @file chima_stream.c
+ * @author
+ * @brief Cifragem incremental (Init/Update/Final) de dados de qualquer tamanho.
+ * @version
+ * @date 2025-06-13
+ *
+ * @copyright Copyright (c) 2025
+ *
+ * Os blocos inteiros de cada Update são entregues às funções em massa
+ * (*_Buf) direto dos buffers do chamador; o estado só guarda o que sobra
+ * de um bloco. Na decifração ECB/CBC o último bloco completo fica retido
+ * até o Final, que é quem sabe que ele carrega o preenchimento.
+ */
+
+
+// INCLUSÕES //
+
+#include "chima_stream.h"
+#include <string.h>
+
+
+// FUNÇÕES //
+
+/**
+ * @brief Prepara o estado para cifrar ou decifrar.
+ *
+ * @param pStream  Estado
+ * @param pCtx     Contexto com as chaves
+ * @param xMode    Modo de operação
+ * @param iv       IV ou contador inicial (ignorado em ECB; pode ser NULL)
+ * @param iDecrypt 1 para decifrar
+ * @return 0 em caso de sucesso, -1 se os parâmetros forem inválidos
+ */
+static int Stream_Init(CHIMA_StreamCtx *pStream, const CHIMA_Ctx *pCtx, CipherMode xMode, const uint8_t *iv, int iDecrypt) {
+    uint32_t bs;
+
+    if (pStream == NULL || pCtx == NULL || xMode > CIPHER_MODE_CTR || (xMode != CIPHER_MODE_ECB && iv == NULL))
+        return -1;
+
+    bs = (pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    memset(pStream, 0, sizeof(*pStream));
+    pStream->pCtx = pCtx;
+    pStream->xMode = xMode;
+    pStream->iDecrypt = iDecrypt;
+    if (xMode != CIPHER_MODE_ECB)
+        memcpy(pStream->aucIv, iv, bs);
+    return 0;
+}
+
+/**
+ * @brief Processa blocos inteiros em ECB ou CBC.
+ */
+static void Blocks_Process(CHIMA_StreamCtx *pStream, const uint8_t *in, uint8_t *out, size_t nblocks) {
+    if (pStream->xMode == CIPHER_MODE_ECB) {
+        if (pStream->iDecrypt)
+            CHIMA_DecryptECB_Buf(pStream->pCtx, in, out, nblocks);
+        else
+            CHIMA_EncryptECB_Buf(pStream->pCtx, in, out, nblocks);
+    } else {
+        if (pStream->iDecrypt)
+            CHIMA_DecryptCBC_Buf(pStream->pCtx, in, out, nblocks, pStream->aucIv);
+        else
+            CHIMA_EncryptCBC_Buf(pStream->pCtx, in, out, nblocks, pStream->aucIv);
+    }
+}
+
+/**
+ * @brief Update dos modos de bloco (ECB/CBC).
+ *
+ * Na cifragem o estado fica com 0 a bs-1 bytes; na decifração, com 1 a
+ * bs bytes assim que algum dado chegou, para que o último bloco só seja
+ * decifrado no Final.
+ */
+static void Block_Update(CHIMA_StreamCtx *pStream, const uint8_t *in, size_t len, uint8_t *out, size_t *pszOutLen) {
+    uint32_t bs = (pStream->pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    size_t take, nfull, rem, written = 0;
+
+    if (pStream->ui32Pos > 0) {
+        take = bs - pStream->ui32Pos;
+        if (take > len)
+            take = len;
+        memcpy(pStream->aucBuf + pStream->ui32Pos, in, take);
+        pStream->ui32Pos += (uint32_t)take;
+        in += take;
+        len -= take;
+        if (pStream->ui32Pos < bs || (pStream->iDecrypt && len == 0)) {
+            *pszOutLen = 0;
+            return;
+        }
+        Blocks_Process(pStream, pStream->aucBuf, out, 1);
+        out += bs;
+        written = bs;
+        pStream->ui32Pos = 0;
+    }
+
+    nfull = len / bs;
+    rem = len % bs;
+    if (pStream->iDecrypt && rem == 0 && nfull > 0) {
+        nfull--;
+        rem = bs;
+    }
+    if (nfull > 0)
+        Blocks_Process(pStream, in, out, nfull);
+    memcpy(pStream->aucBuf, in + nfull * bs, rem);
+    pStream->ui32Pos = (uint32_t)rem;
+
+    *pszOutLen = written + nfull * bs;
+}
+
+/**
+ * @brief Gera o próximo bloco do fluxo de chave (CFB/OFB/CTR).
+ *
+ * Em OFB e CTR o encadeamento avança aqui; em CFB ele é preenchido byte a
+ * byte com o texto cifrado à medida que o bloco é consumido.
+ */
+static void Next_Keystream(CHIMA_StreamCtx *pStream) {
+    static const uint8_t aucZero[16] = {0};
+
+    switch (pStream->xMode) {
+        case CIPHER_MODE_CTR:
+            CHIMA_EncryptCTR_Buf(pStream->pCtx, aucZero, pStream->aucBuf, 1, pStream->aucIv);
+            break;
+        case CIPHER_MODE_OFB:
+            CHIMA_EncryptOFB_Buf(pStream->pCtx, aucZero, pStream->aucBuf, 1, pStream->aucIv);
+            break;
+        default:
+            CHIMA_EncryptECB_Ctx(pStream->pCtx, pStream->aucIv, pStream->aucBuf);
+            break;
+    }
+}
+
+/**
+ * @brief XOR de bytes com o fluxo de chave corrente, a partir de ui32Pos.
+ */
+static void Keystream_Xor(CHIMA_StreamCtx *pStream, const uint8_t *in, uint8_t *out, size_t len) {
+    uint32_t pos = pStream->ui32Pos;
+    uint8_t c;
+
+    for (size_t i = 0; i < len; i++, pos++) {
+        c = in[i];
+        out[i] = c ^ pStream->aucBuf[pos];
+        if (pStream->xMode == CIPHER_MODE_CFB)
+            pStream->aucIv[pos] = pStream->iDecrypt ? c : out[i];
+    }
+    pStream->ui32Pos = pos;
+}
+
+/**
+ * @brief Update dos modos de fluxo (CFB/OFB/CTR).
+ */
+static void Stream_Update(CHIMA_StreamCtx *pStream, const uint8_t *in, size_t len, uint8_t *out, size_t *pszOutLen) {
+    uint32_t bs = (pStream->pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+    size_t take, nfull;
+
+    *pszOutLen = len;
+
+    // Resto do bloco de fluxo anterior
+    if (pStream->ui32Pos > 0) {
+        take = bs - pStream->ui32Pos;
+        if (take > len)
+            take = len;
+        Keystream_Xor(pStream, in, out, take);
+        in += take;
+        out += take;
+        len -= take;
+        if (pStream->ui32Pos < bs)
+            return;
+        pStream->ui32Pos = 0;
+    }
+
+    nfull = len / bs;
+    if (nfull > 0) {
+        switch (pStream->xMode) {
+            case CIPHER_MODE_CTR:
+                CHIMA_EncryptCTR_Buf(pStream->pCtx, in, out, nfull, pStream->aucIv);
+                break;
+            case CIPHER_MODE_OFB:
+                CHIMA_EncryptOFB_Buf(pStream->pCtx, in, out, nfull, pStream->aucIv);
+                break;
+            default:
+                if (pStream->iDecrypt)
+                    CHIMA_DecryptCFB_Buf(pStream->pCtx, in, out, nfull, pStream->aucIv);
+                else
+                    CHIMA_EncryptCFB_Buf(pStream->pCtx, in, out, nfull, pStream->aucIv);
+                break;
+        }
+        in += nfull * bs;
+        out += nfull * bs;
+        len -= nfull * bs;
+    }
+
+    if (len > 0) {
+        Next_Keystream(pStream);
+        Keystream_Xor(pStream, in, out, len);
+    }
+}
+
+/**
+ * @brief Update comum a cifragem e decifração.
+ */
+static int Update(CHIMA_StreamCtx *pStream, const uint8_t *in, size_t len, uint8_t *out, size_t *pszOutLen, int iDecrypt) {
+    if (pStream == NULL || pStream->pCtx == NULL || pszOutLen == NULL || pStream->iDecrypt != iDecrypt)
+        return -1;
+    if (len == 0) {
+        *pszOutLen = 0;
+        return 0;
+    }
+    if (in == NULL || out == NULL)
+        return -1;
+
+    if (pStream->xMode == CIPHER_MODE_ECB || pStream->xMode == CIPHER_MODE_CBC)
+        Block_Update(pStream, in, len, out, pszOutLen);
+    else
+        Stream_Update(pStream, in, len, out, pszOutLen);
+    return 0;
+}
+
+/**
+ * @brief Inicia uma cifragem incremental.
+ *
+ * @param pStream Estado
+ * @param pCtx    Contexto com as chaves
+ * @param xMode   Modo de operação
+ * @param iv      IV ou contador inicial (ignorado em ECB)
+ * @return 0 em caso de sucesso, -1 em erro
+ */
+int CHIMA_EncryptInit(CHIMA_StreamCtx *pStream, const CHIMA_Ctx *pCtx, CipherMode xMode, const uint8_t *iv) {
+    return Stream_Init(pStream, pCtx, xMode, iv, 0);
+}
+
+/**
+ * @brief Cifra mais um trecho de dados.
+ *
+ * @param pStream   Estado
+ * @param in        Dados claros
+ * @param len       Tamanho em bytes (qualquer valor)
+ * @param out       Saída (len + 16 bytes em ECB/CBC)
+ * @param pszOutLen Recebe os bytes escritos
+ * @return 0 em caso de sucesso, -1 em erro
+ */
+int CHIMA_EncryptUpdate(CHIMA_StreamCtx *pStream, const uint8_t *in, size_t len, uint8_t *out, size_t *pszOutLen) {
+    return Update(pStream, in, len, out, pszOutLen, 0);
+}
+
+/**
+ * @brief Encerra a cifragem; em ECB/CBC escreve o último bloco com o
+ * preenchimento PKCS#7.
+ *
+ * @param pStream   Estado (apagado ao final)
+ * @param out       Saída (um bloco em ECB/CBC)
+ * @param pszOutLen Recebe os bytes escritos
+ * @return 0 em caso de sucesso, -1 em erro
+ */
+int CHIMA_EncryptFinal(CHIMA_StreamCtx *pStream, uint8_t *out, size_t *pszOutLen) {
+    uint32_t bs, pad;
+
+    if (pStream == NULL || pStream->pCtx == NULL || pszOutLen == NULL || pStream->iDecrypt)
+        return -1;
+
+    *pszOutLen = 0;
+    if (pStream->xMode == CIPHER_MODE_ECB || pStream->xMode == CIPHER_MODE_CBC) {
+        if (out == NULL)
+            return -1;
+        bs = (pStream->pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+        pad = bs - pStream->ui32Pos;
+        memset(pStream->aucBuf + pStream->ui32Pos, (int)pad, pad);
+        Blocks_Process(pStream, pStream->aucBuf, out, 1);
+        *pszOutLen = bs;
+    }
+    SecureZero(pStream, sizeof(*pStream));
+    return 0;
+}
+
+/**
+ * @brief Inicia uma decifração incremental.
+ *
+ * @param pStream Estado
+ * @param pCtx    Contexto com as chaves
+ * @param xMode   Modo de operação
+ * @param iv      IV ou contador inicial (ignorado em ECB)
+ * @return 0 em caso de sucesso, -1 em erro
+ */
+int CHIMA_DecryptInit(CHIMA_StreamCtx *pStream, const CHIMA_Ctx *pCtx, CipherMode xMode, const uint8_t *iv) {
+    return Stream_Init(pStream, pCtx, xMode, iv, 1);
+}
+
+/**
+ * @brief Decifra mais um trecho de dados.
+ *
+ * @param pStream   Estado
+ * @param in        Dados cifrados
+ * @param len       Tamanho em bytes (qualquer valor)
+ * @param out       Saída (len + 16 bytes em ECB/CBC)
+ * @param pszOutLen Recebe os bytes escritos
+ * @return 0 em caso de sucesso, -1 em erro
+ */
+int CHIMA_DecryptUpdate(CHIMA_StreamCtx *pStream, const uint8_t *in, size_t len, uint8_t *out, size_t *pszOutLen) {
+    return Update(pStream, in, len, out, pszOutLen, 1);
+}
+
+/**
+ * @brief Encerra a decifração; em ECB/CBC decifra o bloco retido e remove
+ * o preenchimento PKCS#7.
+ *
+ * @param pStream   Estado (apagado ao final)
+ * @param out       Saída (até um bloco em ECB/CBC)
+ * @param pszOutLen Recebe os bytes escritos
+ * @return 0 em caso de sucesso, -1 se o tamanho total não for múltiplo
+ *         do bloco ou o preenchimento for inválido
+ */
+int CHIMA_DecryptFinal(CHIMA_StreamCtx *pStream, uint8_t *out, size_t *pszOutLen) {
+    uint8_t block[16], bad = 0;
+    uint32_t bs, pad;
+    int ret = 0;
+
+    if (pStream == NULL || pStream->pCtx == NULL || pszOutLen == NULL || !pStream->iDecrypt)
+        return -1;
+
+    *pszOutLen = 0;
+    if (pStream->xMode == CIPHER_MODE_ECB || pStream->xMode == CIPHER_MODE_CBC) {
+        bs = (pStream->pCtx->xSize == BLOCK_MODE_64) ? 8 : 16;
+        if (out == NULL || pStream->ui32Pos != bs) {
+            ret = -1;
+        } else {
+            Blocks_Process(pStream, pStream->aucBuf, block, 1);
+            pad = block[bs - 1];
+            // Verificação sem desvios que dependam do conteúdo
+            bad |= (uint8_t)(pad == 0) | (uint8_t)(pad > bs);
+            for (uint32_t i = 0; i < bs; i++)
+                bad |= (uint8_t)((block[i] ^ pad) & -(uint8_t)(i >= bs - pad));
+            if (bad) {
+                ret = -1;
+            } else {
+                memcpy(out, block, bs - pad);
+                *pszOutLen = bs - pad;
+            }
+            SecureZero(block, sizeof(block));
+        }
+    }
+    SecureZero(pStream, sizeof(*pStream));
+    return ret;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file chima_stream.h
+ * @author
+ * @brief Cifragem incremental (Init/Update/Final) de dados de qualquer tamanho.
+ * @version
+ * @date 2025-06-13
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef CHIMA_STREAM_H
+#define CHIMA_STREAM_H
+
+
+// INCLUSÕES //
+
+#include "chima_crypto.h"
+
+
+// TIPOS //
+
+/**
+ * @brief Estado de uma cifragem ou decifração incremental.
+ *
+ * Guarda o encadeamento (IV, contador ou registrador de realimentação) e
+ * o bloco parcial entre chamadas. Não copie o estado em uso; o contexto
+ * deve continuar válido até o Final.
+ */
+typedef struct {
+    const CHIMA_Ctx *pCtx;       /**< Contexto com as chaves */
+    CipherMode       xMode;      /**< Modo de operação */
+    int              iDecrypt;   /**< 1 para decifrar */
+    uint32_t         ui32Pos;    /**< Bytes do bloco parcial (ECB/CBC) ou do fluxo já usados (CFB/OFB/CTR) */
+    uint8_t          aucIv[16];  /**< Encadeamento */
+    uint8_t          aucBuf[16]; /**< Bloco parcial (ECB/CBC) ou fluxo de chave corrente (CFB/OFB/CTR) */
+} CHIMA_StreamCtx;
+
+
+// PROTÓTIPOS DE FUNÇÃO //
+
+/*
+ * ECB e CBC usam preenchimento PKCS#7: a cifragem sempre acrescenta de 1
+ * a um bloco inteiro de bytes, e a decifração os remove e valida no
+ * Final. CFB, OFB e CTR não usam preenchimento e a saída tem o mesmo
+ * tamanho da entrada.
+ *
+ * Update aceita qualquer tamanho. Blocos inteiros vão direto de in para
+ * out pelas funções em massa (*_Buf); só o resto de um bloco fica no
+ * estado. Em ECB/CBC out deve comportar len + 16 bytes e não pode
+ * sobrepor in; em CFB/OFB/CTR out comporta len bytes e pode ser igual a
+ * in. *pszOutLen recebe os bytes escritos.
+ *
+ * Todas retornam 0 em caso de sucesso e -1 em erro (parâmetros inválidos
+ * ou, na decifração ECB/CBC, tamanho ou preenchimento inválidos). O Final
+ * apaga o estado.
+ */
+
+int CHIMA_EncryptInit(CHIMA_StreamCtx *pStream, const CHIMA_Ctx *pCtx, CipherMode xMode, const uint8_t *iv);
+int CHIMA_EncryptUpdate(CHIMA_StreamCtx *pStream, const uint8_t *in, size_t len, uint8_t *out, size_t *pszOutLen);
+int CHIMA_EncryptFinal(CHIMA_StreamCtx *pStream, uint8_t *out, size_t *pszOutLen);
+
+int CHIMA_DecryptInit(CHIMA_StreamCtx *pStream, const CHIMA_Ctx *pCtx, CipherMode xMode, const uint8_t *iv);
+int CHIMA_DecryptUpdate(CHIMA_StreamCtx *pStream, const uint8_t *in, size_t len, uint8_t *out, size_t *pszOutLen);
+int CHIMA_DecryptFinal(CHIMA_StreamCtx *pStream, uint8_t *out, size_t *pszOutLen);
+
+
+#endif /* CHIMA_STREAM_H */
@@ -0,0 +1,44 @@
+/**
+ * @file chima_xts.h
+ * @author
+ * @brief Modo XTS por setor para armazenamento com acesso aleatório.
+ * @version
+ * @date 2025-06-13
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#ifndef CHIMA_XTS_H
+#define CHIMA_XTS_H
+
+
+// INCLUSÕES //
+
+#include "chima_crypto.h"
+
+
+// PROTÓTIPOS DE FUNÇÃO //
+
+/*
+ * XTS (IEEE 1619) sobre a CHIMA de 128 bits: cada setor é cifrado de forma
+ * independente com o ajuste T = E_K2(número do setor em little-endian),
+ * multiplicado por x em GF(2^128) a cada bloco, e cada bloco vira
+ * E_K1(P ^ T) ^ T. Um setor pode ser lido ou regravado sem tocar nos
+ * vizinhos.
+ *
+ * pDataCtx (K1) e pTweakCtx (K2) devem usar BLOCK_MODE_128 e chaves
+ * diferentes. Processam nsectors setores consecutivos de szSectorSize
+ * bytes (múltiplo de 16) a partir de ui64Sector; out pode ser igual a in.
+ * Os blocos de vários setores são entregues juntos aos núcleos em massa.
+ *
+ * Retornam 0 em caso de sucesso e -1 se os parâmetros forem inválidos.
+ */
+
+int CHIMA_XtsEncrypt(const CHIMA_Ctx *pDataCtx, const CHIMA_Ctx *pTweakCtx, uint64_t ui64Sector,
+     size_t szSectorSize, const uint8_t *in, uint8_t *out, size_t nsectors);
+int CHIMA_XtsDecrypt(const CHIMA_Ctx *pDataCtx, const CHIMA_Ctx *pTweakCtx, uint64_t ui64Sector,
+     size_t szSectorSize, const uint8_t *in, uint8_t *out, size_t nsectors);
+
+
+#endif /* CHIMA_XTS_H */
@@ -17,6 +17,8 @@
 
 #include "chima_genkey.h"
 #include "chima_crypto.h"
+#include "chima_packed.h"
+#include "chima_aead.h"
 #include "autentication.h"
 #include "utils.h"
 
@@ -126,6 +128,94 @@ void testar_value(float PLAIN_TEXT, int index) {
 }
 
 
+/**
+ * @brief Demonstra a cifragem de um vetor inteiro de valores de uma vez.
+ *
+ * Os valores são empacotados lado a lado nos blocos, com um único padding
+ * ao final, em vez de um bloco por valor como em testar_value.
+ */
+void testar_vetor(const float *values, int count) {
+    uint8_t ciphertext[256];
+    float decrypted[16];
+    uint8_t iv[16];
+    size_t szCipherLen = 0, szCount = 0;
+    CHIMA_Ctx xCtx;
+    int status;
+
+    FloatArray128 user_key;
+    GenerateKey128(ITER_BUFFER_SIZE, LOGISTIC_R, LOGISTIC_X0, &user_key);
+    CHIMA_CtxInit(&xCtx, user_key.bytes, BLOCK_SIZE, NUMBER_OF_ROUNDS);
+
+    for (int i = 0; i < 16; i++) iv[i] = i;
+
+    // count valores em CHIMA_PackedSize(&xCtx, count) bytes, cifrados de uma vez
+    CHIMA_EncryptFloatArray(&xCtx, OPERATION_MODE, iv, values, count, ciphertext, &szCipherLen);
+    status = CHIMA_DecryptFloatArray(&xCtx, OPERATION_MODE, iv, ciphertext, szCipherLen, decrypted, 16, &szCount);
+    CHIMA_CtxFree(&xCtx);
+
+
+    // A partir daqui é só print do usuário
+
+    printf("VETOR: %d valores em %zu bytes cifrados (%d bytes um bloco por valor)\n",
+           count, szCipherLen, count * ((BLOCK_SIZE == BLOCK_MODE_64) ? 8 : 16));
+
+    if (status != 0 || szCount != (size_t)count) {
+        printf("[ERRO] Vetor inválido!\n");
+    } else if (memcmp(values, decrypted, count * sizeof(float)) == 0) {
+        printf("[OK] vetor recuperado com sucesso.\n");
+    } else {
+        printf("[FALHA] vetor recuperado incorretamente.\n");
+    }
+
+    printf("============================\n\n");
+}
+
+
+/**
+ * @brief Confere que nonces vizinhos do AEAD geram fluxos sem relação.
+ *
+ * Cifra zeros (o texto cifrado é o próprio fluxo) com os nonces 0 e 1 e
+ * procura qualquer bloco de um fluxo no outro, nos dois tamanhos de bloco.
+ */
+void testar_aead_nonces(void) {
+    static const uint8_t zeros[64] = {0};
+    uint8_t c1[64], c2[64], tag[CHIMA_AEAD_TAG_BYTES];
+    uint8_t nonce1[12] = {0}, nonce2[12] = {0};
+    BlockCipherSize sizes[2] = { BLOCK_MODE_64, BLOCK_MODE_128 };
+    CHIMA_Ctx xCtx;
+    int repetidos = 0;
+
+    FloatArray128 user_key;
+    GenerateKey128(ITER_BUFFER_SIZE, LOGISTIC_R, LOGISTIC_X0, &user_key);
+
+    for (int s = 0; s < 2; s++) {
+        uint32_t bs = (sizes[s] == BLOCK_MODE_64) ? 8 : 16;
+
+        // O nonce tem o tamanho do bloco menos 4 bytes
+        nonce2[bs - 5] = 1;
+        CHIMA_CtxInit(&xCtx, user_key.bytes, sizes[s], NUMBER_OF_ROUNDS);
+        CHIMA_AeadEncrypt(&xCtx, nonce1, NULL, 0, zeros, sizeof(zeros), c1, tag);
+        CHIMA_AeadEncrypt(&xCtx, nonce2, NULL, 0, zeros, sizeof(zeros), c2, tag);
+        CHIMA_CtxFree(&xCtx);
+        nonce2[bs - 5] = 0;
+
+        for (uint32_t i = 0; i < sizeof(zeros); i += bs)
+            for (uint32_t j = 0; j < sizeof(zeros); j += bs)
+                repetidos += (memcmp(c1 + i, c2 + j, bs) == 0);
+    }
+
+
+    // A partir daqui é só print do usuário
+
+    if (repetidos == 0) {
+        printf("[OK] nonces vizinhos do AEAD geram fluxos distintos.\n");
+    } else {
+        printf("[FALHA] %d blocos de fluxo repetidos entre nonces vizinhos.\n", repetidos);
+    }
+
+    printf("============================\n\n");
+}
+
 
 /**
  * @brief Função de escrita usada no exemplo.
@@ -174,5 +264,8 @@ int main(void) {
         testar_value(tests[i], i); // função do usuário de teste da criptografia, não documentar
     }
 
+    testar_vetor(tests, total);
+    testar_aead_nonces();
+
     return 0;
 }
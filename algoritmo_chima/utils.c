@@ -235,6 +235,124 @@ int RemovePadding(const uint8_t *block, BlockCipherSize modo, float *value) {
     return 0;
 }
 
+/**
+ * @brief Tamanho de um vetor empacotado por PaddingArray.
+ *
+ * @param szCount Quantidade de valores
+ * @param modo    Tamanho do bloco
+ * @return Bytes (múltiplo do bloco) ou 0 se szCount for grande demais
+ */
+size_t PackedSize(size_t szCount, BlockCipherSize modo) {
+    size_t block_size = (modo == BLOCK_MODE_64) ? 8 : 16;
+    size_t len;
+
+    if (szCount > UINT32_MAX || szCount > (SIZE_MAX - PACKED_HEADER_BYTES - block_size) / PACKED_VALUE_BYTES)
+        return 0;
+    len = PACKED_HEADER_BYTES + szCount * PACKED_VALUE_BYTES;
+    return len + block_size - len % block_size;
+}
+
+/**
+ * @brief Empacota um vetor de float ou int32_t em blocos contíguos.
+ *
+ * Os valores ocupam os blocos sem espaço entre eles; só o último bloco
+ * leva padding, em vez de um bloco inteiro por valor.
+ *
+ * @param pValues Valores (float ou int32_t)
+ * @param szCount Quantidade de valores
+ * @param out     Saída com PackedSize(szCount, modo) bytes
+ * @param modo    Tamanho do bloco
+ * @return Bytes escritos ou 0 se szCount for grande demais
+ */
+size_t PaddingArray(const void *pValues, size_t szCount, uint8_t *out, BlockCipherSize modo) {
+    size_t total = PackedSize(szCount, modo);
+    size_t len = PACKED_HEADER_BYTES + szCount * PACKED_VALUE_BYTES;
+    uint32_t count = (uint32_t)szCount;
+
+    if (total == 0)
+        return 0;
+
+    memcpy(out, &count, PACKED_HEADER_BYTES);
+    if (szCount > 0)
+        memcpy(out + PACKED_HEADER_BYTES, pValues, szCount * PACKED_VALUE_BYTES);
+    memset(out + len, (int)(total - len), total - len);
+    return total;
+}
+
+/**
+ * @brief Confere o cabeçalho de um vetor empacotado por PaddingArray.
+ *
+ * @param in         Início do vetor (já decifrado), com ao menos
+ *                   PACKED_HEADER_BYTES bytes se szLen os tiver
+ * @param szLen      Tamanho total em bytes
+ * @param modo       Tamanho do bloco
+ * @param pValues    Destino dos valores (NULL só se não houver valores)
+ * @param szMaxCount Capacidade de pValues, em valores
+ * @param pui32Count Recebe a quantidade de valores
+ * @return Bytes de cabeçalho e valores (início do padding) ou 0 em erro
+ */
+size_t CheckPackedHeader(const uint8_t *in, size_t szLen, BlockCipherSize modo, const void *pValues, size_t szMaxCount, uint32_t *pui32Count) {
+    uint32_t count;
+
+    if (in == NULL || pui32Count == NULL || szLen < PACKED_HEADER_BYTES)
+        return 0;
+
+    memcpy(&count, in, PACKED_HEADER_BYTES);
+    if (PackedSize(count, modo) != szLen || count > szMaxCount || (pValues == NULL && count > 0))
+        return 0;
+
+    *pui32Count = count;
+    return PACKED_HEADER_BYTES + (size_t)count * PACKED_VALUE_BYTES;
+}
+
+/**
+ * @brief Confere o padding de PaddingArray contido em um trecho.
+ *
+ * O trecho é comparado inteiro, sem desvio no primeiro byte errado.
+ *
+ * @param chunk      Bytes [szOffset, szOffset + szChunkLen) do vetor
+ * @param szOffset   Posição do trecho no vetor
+ * @param szChunkLen Tamanho do trecho
+ * @param szData     Início do padding (retorno de CheckPackedHeader)
+ * @param szLen      Tamanho total do vetor
+ * @return 0 se o padding contido no trecho estiver correto
+ */
+uint8_t CheckPackedPadding(const uint8_t *chunk, size_t szOffset, size_t szChunkLen, size_t szData, size_t szLen) {
+    uint8_t diff = 0;
+
+    for (size_t i = (szOffset > szData) ? szOffset : szData; i < szOffset + szChunkLen; i++)
+        diff |= (uint8_t)(chunk[i - szOffset] ^ (szLen - szData));
+    return diff;
+}
+
+/**
+ * @brief Desfaz PaddingArray.
+ *
+ * @param in         Vetor empacotado (já decifrado)
+ * @param szLen      Tamanho em bytes
+ * @param modo       Tamanho do bloco
+ * @param pValues    Recebe os valores
+ * @param szMaxCount Capacidade de pValues, em valores
+ * @param pszCount   Recebe a quantidade de valores
+ * @return 0 em caso de sucesso, -1 em erro
+ */
+int RemovePaddingArray(const uint8_t *in, size_t szLen, BlockCipherSize modo, void *pValues, size_t szMaxCount, size_t *pszCount) {
+    size_t len;
+    uint32_t count = 0;
+
+    if (pszCount == NULL)
+        return -1;
+
+    len = CheckPackedHeader(in, szLen, modo, pValues, szMaxCount, &count);
+    if (len == 0 || CheckPackedPadding(in, 0, szLen, len, szLen) != 0)
+        return -1;
+
+    if (count > 0)
+        memcpy(pValues, in + PACKED_HEADER_BYTES, (size_t)count * PACKED_VALUE_BYTES);
+    *pszCount = count;
+    return 0;
+}
+
 /* ========================== */
 /* === Operações com XOR ==== */
 /* ========================== */
@@ -251,3 +369,23 @@ void XOR_Blocks(uint8_t *dst, const uint8_t *a, const uint8_t *b, uint32_t len)
     for (uint32_t i = 0; i < len; i++)
         dst[i] = a[i] ^ b[i];
 }
+
+/**
+ * @brief Zera memória com dados sensíveis (chaves, tabelas derivadas).
+ *
+ * A barreira de compilador após o memset impede que a escrita seja
+ * eliminada como armazenamento morto antes de um free ou do fim da função.
+ *
+ * @param dst Região a zerar
+ * @param len Tamanho em bytes
+ */
+void SecureZero(void *dst, size_t len) {
+#if defined(__GNUC__)
+    memset(dst, 0, len);
+    __asm__ __volatile__("" : : "r"(dst) : "memory");
+#else
+    volatile uint8_t *p = (volatile uint8_t *)dst;
+    while (len--)
+        *p++ = 0;
+#endif
+}
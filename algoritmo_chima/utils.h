@@ -19,6 +19,14 @@
 #include "DrvH_PRINT.h"
 
 
+// DEFINIÇÕES //
+
+/** Bytes do cabeçalho de PaddingArray (quantidade de valores) */
+#define PACKED_HEADER_BYTES 4
+/** Bytes de cada valor em PaddingArray (float ou int32_t) */
+#define PACKED_VALUE_BYTES  4
+
+
 // TIPOS //
 /**
  * @brief 
@@ -72,10 +80,63 @@ void Padding(float value, uint8_t *block, BlockCipherSize modo);
  * @return 0 em caso de sucesso
  */
 int RemovePadding(const uint8_t *block, BlockCipherSize modo, float *value);
+
+/**
+ * @brief Tamanho de um vetor empacotado por PaddingArray.
+ * @return Bytes (múltiplo do bloco) ou 0 se szCount for grande demais
+ */
+size_t PackedSize(size_t szCount, BlockCipherSize modo);
+
+/**
+ * @brief Empacota um vetor de float ou int32_t em blocos contíguos.
+ *
+ * Formato: quantidade de valores (uint32_t), os valores lado a lado e um
+ * único padding PKCS ao final, tudo na ordem de bytes do processador como
+ * em Padding. out deve ter PackedSize(szCount, modo) bytes.
+ *
+ * @return Bytes escritos ou 0 se szCount for grande demais
+ */
+size_t PaddingArray(const void *pValues, size_t szCount, uint8_t *out, BlockCipherSize modo);
+
+/**
+ * @brief Confere o cabeçalho de um vetor empacotado por PaddingArray.
+ *
+ * Exige que a quantidade corresponda a szLen, caiba em szMaxCount e que
+ * pValues exista se houver valores.
+ *
+ * @return Bytes de cabeçalho e valores (início do padding) ou 0 em erro
+ */
+size_t CheckPackedHeader(const uint8_t *in, size_t szLen, BlockCipherSize modo, const void *pValues, size_t szMaxCount, uint32_t *pui32Count);
+
+/**
+ * @brief Confere, sem desvio, o padding de PaddingArray contido no trecho
+ *        [szOffset, szOffset + szChunkLen) de um vetor de szLen bytes.
+ *
+ * Permite validar um vetor decifrado por partes.
+ *
+ * @return 0 se o padding contido no trecho estiver correto
+ */
+uint8_t CheckPackedPadding(const uint8_t *chunk, size_t szOffset, size_t szChunkLen, size_t szData, size_t szLen);
+
+/**
+ * @brief Desfaz PaddingArray.
+ *
+ * Valida o cabeçalho (CheckPackedHeader) e o padding (CheckPackedPadding)
+ * antes de copiar os valores; em erro nada é escrito em pValues.
+ *
+ * @return 0 em caso de sucesso, -1 se o formato for inválido ou houver
+ *         mais de szMaxCount valores
+ */
+int RemovePaddingArray(const uint8_t *in, size_t szLen, BlockCipherSize modo, void *pValues, size_t szMaxCount, size_t *pszCount);
 /**
  * @brief Realiza operação XOR byte a byte.
  */
 void XOR_Blocks(uint8_t *dst, const uint8_t *a, const uint8_t *b, uint32_t len);
 
+/**
+ * @brief Zera uma região de memória sem que o compilador remova a escrita.
+ */
+void SecureZero(void *dst, size_t len);
+
 
 #endif /* UTILS_H */